@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include "Common/CommonFuncs.h"
 #include "Common/CPUDetect.h"
 #include "Common/Hash.h"
@@ -319,6 +320,111 @@ u64 GetHashHiresTexture(const u8 *src, u32 len, u32 samples)
 
 	return h;
 }
+
+#ifdef _M_X86
+// Secret for GetAVX2Hash. Each stripe of a block is keyed at a different
+// offset so that swapping stripes changes the hash; the last 64 bytes also
+// scramble the accumulators after every block.
+static const u64 s_avx2_hash_secret[24] =
+{
+	0xe220a8397b1dcdafULL, 0x6e789e6aa1b965f4ULL, 0x06c45d188009454fULL, 0xf88bb8a8724c81ecULL,
+	0x1b39896a51a8749bULL, 0x53cb9f0c747ea2eaULL, 0x2c829abe1f4532e1ULL, 0xc584133ac916ab3cULL,
+	0x3ee5789041c98ac3ULL, 0xf3b8488c368cb0a6ULL, 0x657eecdd3cb13d09ULL, 0xc2d326e0055bdef6ULL,
+	0x8621a03fe0bbdb7bULL, 0x8e1f7555983aa92fULL, 0xb54e0f1600cc4d19ULL, 0x84bb3f97971d80abULL,
+	0x7d29825c75521255ULL, 0xc3cf17102b7f7f86ULL, 0x3466e9a083914f64ULL, 0xd81a8d2b5a4485acULL,
+	0xdb01602b100b9ed7ULL, 0xa9038a921825f10dULL, 0xedf5f1d90dca2f6aULL, 0x54496ad67bd2634cULL,
+};
+
+static const u32 AVX2_HASH_STRIPE_SIZE = 64;
+static const u32 AVX2_HASH_BLOCK_STRIPES = 16;
+
+ATTRIBUTE_TARGET("avx2")
+static inline void Avx2HashAccumulate(__m256i acc[2], const u8* data, const u64* key)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		const __m256i d = _mm256_loadu_si256((const __m256i*)data + i);
+		const __m256i k = _mm256_loadu_si256((const __m256i*)key + i);
+		const __m256i dk = _mm256_xor_si256(d, k);
+		const __m256i product = _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32));
+		const __m256i swapped = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+		acc[i] = _mm256_add_epi64(acc[i], _mm256_add_epi64(product, swapped));
+	}
+}
+
+ATTRIBUTE_TARGET("avx2")
+static inline void Avx2HashScramble(__m256i acc[2], const u64* key)
+{
+	const __m256i prime = _mm256_set1_epi32(0x9E3779B1);
+	for (int i = 0; i < 2; i++)
+	{
+		const __m256i k = _mm256_loadu_si256((const __m256i*)key + i);
+		__m256i a = _mm256_xor_si256(acc[i], _mm256_srli_epi64(acc[i], 47));
+		a = _mm256_xor_si256(a, k);
+		// 64x32 bit multiply by the prime.
+		const __m256i lo = _mm256_mul_epu32(a, prime);
+		const __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime);
+		acc[i] = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+	}
+}
+
+// xxh3-style hash, processing 64 bytes per step with AVX2. Like the other
+// hashes, a nonzero sample count only looks at evenly spaced parts of the
+// data.
+ATTRIBUTE_TARGET("avx2")
+u64 GetAVX2Hash(const u8 *src, u32 len, u32 samples)
+{
+	__m256i acc[2] = {
+		_mm256_set_epi64x(0x165667B19E3779F9ULL, 0x9E3779B185EBCA87ULL, 0xC2B2AE3D27D4EB4FULL, len),
+		_mm256_set_epi64x(0x27D4EB2F165667C5ULL, 0x85EBCA77C2B2AE63ULL, 0x9E3779B97F4A7C15ULL, ~(u64)len),
+	};
+
+	// Samples are counted in 8 byte words like in the other hashes, so a
+	// stripe covers eight of them.
+	const u32 num_stripes = len / AVX2_HASH_STRIPE_SIZE;
+	const u32 stripe_samples = std::max(samples / 8, 1u);
+	u32 step = 1;
+	if (samples != 0 && stripe_samples < num_stripes)
+		step = num_stripes / stripe_samples;
+
+	const u32 stride = step * AVX2_HASH_STRIPE_SIZE;
+	const u32 num_samples = (num_stripes + step - 1) / step;
+	const u8* data = src;
+	u32 n = 0;
+	for (; n + AVX2_HASH_BLOCK_STRIPES <= num_samples; n += AVX2_HASH_BLOCK_STRIPES)
+	{
+		for (u32 lane = 0; lane < AVX2_HASH_BLOCK_STRIPES; lane++, data += stride)
+			Avx2HashAccumulate(acc, data, s_avx2_hash_secret + lane);
+		Avx2HashScramble(acc, s_avx2_hash_secret + 16);
+	}
+	for (u32 lane = 0; n < num_samples; n++, lane++, data += stride)
+		Avx2HashAccumulate(acc, data, s_avx2_hash_secret + lane);
+
+	// The tail is hashed as one last, possibly overlapping, stripe.
+	if (len % AVX2_HASH_STRIPE_SIZE)
+	{
+		if (len >= AVX2_HASH_STRIPE_SIZE)
+		{
+			Avx2HashAccumulate(acc, src + len - AVX2_HASH_STRIPE_SIZE, s_avx2_hash_secret + 7);
+		}
+		else
+		{
+			u8 tail[AVX2_HASH_STRIPE_SIZE] = {};
+			memcpy(tail, src, len);
+			Avx2HashAccumulate(acc, tail, s_avx2_hash_secret + 7);
+		}
+	}
+
+	u64 lanes[8];
+	_mm256_storeu_si256((__m256i*)lanes, acc[0]);
+	_mm256_storeu_si256((__m256i*)lanes + 1, acc[1]);
+
+	u64 h = len * 0x9E3779B185EBCA87ULL;
+	for (int i = 0; i < 8; i++)
+		h = (h ^ fmix64(lanes[i] ^ s_avx2_hash_secret[i])) * 0xC2B2AE3D27D4EB4FULL;
+	return fmix64(h);
+}
+#endif
 #else
 // CRC32 hash using the SSE4.2 instruction
 u64 GetCRC32(const u8 *src, u32 len, u32 samples)
@@ -526,6 +632,13 @@ u64 GetHash64(const u8 *src, u32 len, u32 samples)
 // sets the hash function used for the texture cache
 void SetHash64Function()
 {
+#if defined(_M_X86) && _ARCH_64
+	if (cpu_info.bAVX2) // wide xxh3-style version
+	{
+		ptrHashFunction = &GetAVX2Hash;
+	}
+	else
+#endif
 #if _M_SSE >= 0x402
 	if (cpu_info.bSSE4_2) // sse crc32 version
 	{
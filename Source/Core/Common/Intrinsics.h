@@ -28,4 +28,12 @@
 # endif
 #endif
 
+// Lets a function use instructions beyond the build's baseline. Only call
+// such functions after checking cpu_info.
+#ifdef _MSC_VER
+#define ATTRIBUTE_TARGET(x)
+#else
+#define ATTRIBUTE_TARGET(x) __attribute__((target(x)))
+#endif
+
 #endif // _M_X86
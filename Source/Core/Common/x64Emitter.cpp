@@ -175,14 +175,14 @@ void OpArg::WriteVex(XEmitter* emit, X64Reg regOp1, X64Reg regOp2, int L, int pp
 	// do we need any VEX fields that only appear in the three-byte form?
 	if (X == 1 && B == 1 && W == 0 && mmmmm == 1)
 	{
-		u8 RvvvvLpp = (R << 7) | (vvvv << 3) | (L << 1) | pp;
+		u8 RvvvvLpp = (R << 7) | (vvvv << 3) | (L << 2) | pp;
 		emit->Write8(0xC5);
 		emit->Write8(RvvvvLpp);
 	}
 	else
 	{
 		u8 RXBmmmmm = (R << 7) | (X << 6) | (B << 5) | mmmmm;
-		u8 WvvvvLpp = (W << 7) | (vvvv << 3) | (L << 1) | pp;
+		u8 WvvvvLpp = (W << 7) | (vvvv << 3) | (L << 2) | pp;
 		emit->Write8(0xC4);
 		emit->Write8(RXBmmmmm);
 		emit->Write8(WvvvvLpp);
@@ -1406,17 +1406,31 @@ static int GetVEXpp(u8 opPrefix)
 }
 
 void XEmitter::WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int W, int extrabytes)
+{
+	WriteAVXOp(128, opPrefix, op, regOp1, regOp2, arg, W, extrabytes);
+}
+
+void XEmitter::WriteAVXOp(int bits, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int W, int extrabytes)
 {
 	if (!cpu_info.bAVX)
 		PanicAlert("Trying to use AVX on a system that doesn't support it. Bad programmer.");
+	if (bits != 128 && bits != 256)
+		PanicAlert("AVX instructions only support 128-bit and 256-bit vectors!");
 	int mmmmm = GetVEXmmmmm(op);
 	int pp = GetVEXpp(opPrefix);
-	// FIXME: we currently don't support 256-bit instructions, and "size" is not the vector size here
-	arg.WriteVex(this, regOp1, regOp2, 0, pp, mmmmm, W);
+	arg.WriteVex(this, regOp1, regOp2, bits == 256, pp, mmmmm, W);
 	Write8(op & 0xFF);
 	arg.WriteRest(this, extrabytes, regOp1);
 }
 
+void XEmitter::WriteAVX2Op(int bits, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int W, int extrabytes)
+{
+	// The 128-bit forms of the integer instructions only need AVX
+	if (bits == 256 && !cpu_info.bAVX2)
+		PanicAlert("Trying to use AVX2 on a system that doesn't support it. Bad programmer.");
+	WriteAVXOp(bits, opPrefix, op, regOp1, regOp2, arg, W, extrabytes);
+}
+
 // Like the above, but more general; covers GPR-based VEX operations, like BMI1/2
 void XEmitter::WriteVEXOp(int size, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int extrabytes)
 {
@@ -1841,6 +1855,44 @@ void XEmitter::VPANDN(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0x6
 void XEmitter::VPOR(X64Reg regOp1, X64Reg regOp2, OpArg arg)     {WriteAVXOp(0x66, 0xEB, regOp1, regOp2, arg);}
 void XEmitter::VPXOR(X64Reg regOp1, X64Reg regOp2, OpArg arg)    {WriteAVXOp(0x66, 0xEF, regOp1, regOp2, arg);}
 
+void XEmitter::VZEROUPPER()
+{
+	if (!cpu_info.bAVX)
+		PanicAlert("Trying to use AVX on a system that doesn't support it. Bad programmer.");
+	Write8(0xC5);
+	Write8(0xF8);
+	Write8(0x77);
+}
+
+void XEmitter::VMOVD_xmm(X64Reg dest, const OpArg &arg)            {WriteAVXOp(0x66, 0x6E, dest, INVALID_REG, arg);}
+void XEmitter::VMOVQ_xmm(X64Reg dest, OpArg arg)                   {WriteAVXOp(0xF3, 0x7E, dest, INVALID_REG, arg);}
+void XEmitter::VMOVSS(OpArg arg, X64Reg regOp)                     {WriteAVXOp(0xF3, 0x11, regOp, INVALID_REG, arg);}
+void XEmitter::VMOVLPS(OpArg arg, X64Reg regOp)                    {WriteAVXOp(0x00, 0x13, regOp, INVALID_REG, arg);}
+void XEmitter::VMOVUPS(OpArg arg, X64Reg regOp)                    {WriteAVXOp(0x00, 0x11, regOp, INVALID_REG, arg);}
+void XEmitter::VEXTRACTPS(OpArg arg, X64Reg regOp, u8 subreg)      {WriteAVXOp(0x66, 0x3A17, regOp, INVALID_REG, arg, 0, 1); Write8(subreg);}
+void XEmitter::VPINSRD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 subreg) {WriteAVXOp(0x66, 0x3A22, regOp1, regOp2, arg, 0, 1); Write8(subreg);}
+void XEmitter::VCVTSI2SS(X64Reg regOp1, X64Reg regOp2, OpArg arg)  {WriteAVXOp(0xF3, 0x2A, regOp1, regOp2, arg);}
+
+void XEmitter::VMOVDQU(int bits, X64Reg regOp, OpArg arg)                    {WriteAVXOp(bits, 0xF3, 0x6F, regOp, INVALID_REG, arg);}
+void XEmitter::VMULPS(int bits, X64Reg regOp1, X64Reg regOp2, OpArg arg)     {WriteAVXOp(bits, 0x00, sseMUL, regOp1, regOp2, arg);}
+void XEmitter::VCVTDQ2PS(int bits, X64Reg regOp, OpArg arg)                  {WriteAVXOp(bits, 0x00, 0x5B, regOp, INVALID_REG, arg);}
+void XEmitter::VPADDD(int bits, X64Reg regOp1, X64Reg regOp2, OpArg arg)     {WriteAVX2Op(bits, 0x66, 0xFE, regOp1, regOp2, arg);}
+void XEmitter::VPSHUFB(int bits, X64Reg regOp1, X64Reg regOp2, OpArg arg)    {WriteAVX2Op(bits, 0x66, 0x3800, regOp1, regOp2, arg);}
+void XEmitter::VPSHUFD(int bits, X64Reg regOp, OpArg arg, u8 shuffle)        {WriteAVX2Op(bits, 0x66, 0x70, regOp, INVALID_REG, arg, 0, 1); Write8(shuffle);}
+void XEmitter::VPSRAD(int bits, X64Reg regOp1, X64Reg regOp2, u8 shift)      {WriteAVX2Op(bits, 0x66, 0x72, (X64Reg)4, regOp1, R(regOp2), 0, 1); Write8(shift);}
+void XEmitter::VBROADCASTSS(int bits, X64Reg regOp, OpArg arg)               {WriteAVXOp(bits, 0x66, 0x3818, regOp, INVALID_REG, arg);}
+void XEmitter::VBROADCASTI128(X64Reg regOp, OpArg arg)                       {WriteAVX2Op(256, 0x66, 0x385A, regOp, INVALID_REG, arg);}
+void XEmitter::VINSERTI128(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 subreg) {WriteAVX2Op(256, 0x66, 0x3A38, regOp1, regOp2, arg, 0, 1); Write8(subreg);}
+void XEmitter::VEXTRACTI128(OpArg arg, X64Reg regOp, u8 subreg)              {WriteAVX2Op(256, 0x66, 0x3A39, regOp, INVALID_REG, arg, 0, 1); Write8(subreg);}
+
+void XEmitter::VPGATHERDD(int bits, X64Reg regOp, OpArg arg, X64Reg mask)
+{
+	// Gathers were added in AVX2, even the 128-bit form
+	if (!cpu_info.bAVX2)
+		PanicAlert("Trying to use AVX2 on a system that doesn't support it. Bad programmer.");
+	WriteAVX2Op(bits, 0x66, 0x3890, regOp, mask, arg);
+}
+
 void XEmitter::VFMADD132PS(X64Reg regOp1, X64Reg regOp2, OpArg arg)    {WriteAVXOp(0x66, 0x3898, regOp1, regOp2, arg);}
 void XEmitter::VFMADD213PS(X64Reg regOp1, X64Reg regOp2, OpArg arg)    {WriteAVXOp(0x66, 0x38A8, regOp1, regOp2, arg);}
 void XEmitter::VFMADD231PS(X64Reg regOp1, X64Reg regOp2, OpArg arg)    {WriteAVXOp(0x66, 0x38B8, regOp1, regOp2, arg);}
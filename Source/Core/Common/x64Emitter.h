@@ -315,6 +315,8 @@ private:
 	void WriteSSE41Op(u8 opPrefix, u16 op, X64Reg regOp, OpArg arg, int extrabytes = 0);
 	void WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp, OpArg arg, int W = 0, int extrabytes = 0);
 	void WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int W = 0, int extrabytes = 0);
+	void WriteAVXOp(int bits, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int W = 0, int extrabytes = 0);
+	void WriteAVX2Op(int bits, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int W = 0, int extrabytes = 0);
 	void WriteVEXOp(int size, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int extrabytes = 0);
 	void WriteBMI1Op(int size, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int extrabytes = 0);
 	void WriteBMI2Op(int size, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int extrabytes = 0);
@@ -819,6 +821,34 @@ public:
 	void VPOR(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VPXOR(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 
+	void VZEROUPPER();
+
+	// AVX: 128-bit forms of SSE moves and conversions, for code that also uses 256-bit registers
+	void VMOVD_xmm(X64Reg dest, const OpArg &arg);
+	void VMOVQ_xmm(X64Reg dest, OpArg arg);
+	void VMOVSS(OpArg arg, X64Reg regOp);
+	void VMOVLPS(OpArg arg, X64Reg regOp);
+	void VMOVUPS(OpArg arg, X64Reg regOp);
+	void VEXTRACTPS(OpArg arg, X64Reg regOp, u8 subreg);
+	void VPINSRD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 subreg);
+	void VCVTSI2SS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+
+	// AVX/AVX2: bits is the vector size, 128 or 256
+	void VMOVDQU(int bits, X64Reg regOp, OpArg arg);
+	void VMULPS(int bits, X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VCVTDQ2PS(int bits, X64Reg regOp, OpArg arg);
+	void VPADDD(int bits, X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VPSHUFB(int bits, X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VPSHUFD(int bits, X64Reg regOp, OpArg arg, u8 shuffle);
+	void VPSRAD(int bits, X64Reg regOp1, X64Reg regOp2, u8 shift);
+	void VBROADCASTSS(int bits, X64Reg regOp, OpArg arg);
+	void VBROADCASTI128(X64Reg regOp, OpArg arg);
+	// The address has to use a vector register as index: MComplex(base, XMMn, scale, offset).
+	// The mask is cleared by the instruction.
+	void VPGATHERDD(int bits, X64Reg regOp, OpArg arg, X64Reg mask);
+	void VINSERTI128(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 subreg);
+	void VEXTRACTI128(OpArg arg, X64Reg regOp, u8 subreg);
+
 	// FMA3
 	void VFMADD132PS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VFMADD213PS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
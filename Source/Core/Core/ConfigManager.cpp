@@ -791,6 +791,10 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("BBA_MAC",           &m_bba_mac);
 	core->Get("TimeProfiling",     &m_LocalCoreStartupParameter.bJITILTimeProfiling, false);
 	core->Get("OutputIR",          &m_LocalCoreStartupParameter.bJITILOutputIR,      false);
+	core->Get("JITPersistentProfile", &m_LocalCoreStartupParameter.bJITPersistentProfile, false);
+	core->Get("JITFollowBranches", &m_LocalCoreStartupParameter.bJITFollowBranches, false);
+	core->Get("JITReturnStack",    &m_LocalCoreStartupParameter.bJITReturnStack,    true);
+	core->Get("JITSpeculativeCompile", &m_LocalCoreStartupParameter.bJITSpeculativeCompile, false);
 	for (int i = 0; i < MAX_SI_CHANNELS; ++i)
 	{
 		core->Get(StringFromFormat("SIDevice%i", i), (u32*)&m_SIDevice[i], (i == 0) ? SIDEVICE_GC_CONTROLLER : SIDEVICE_NONE);
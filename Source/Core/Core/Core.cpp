@@ -358,7 +358,10 @@ static void CpuThread()
 	}
 
 	if (_CoreParameter.bFastmem)
+	{
 		EMM::InstallExceptionHandler(); // Let's run under memory watch
+		Memory::EnableWriteWatch();
+	}
 
 	if (!s_state_filename.empty())
 		State::LoadAs(s_state_filename);
@@ -395,7 +398,10 @@ static void CpuThread()
 		g_video_backend->Video_Cleanup();
 
 	if (_CoreParameter.bFastmem)
+	{
+		Memory::DisableWriteWatch();
 		EMM::UninstallExceptionHandler();
+	}
 
 	return;
 }
@@ -33,6 +33,8 @@ SCoreStartupParameter::SCoreStartupParameter()
   bJITPairedOff(false), bJITSystemRegistersOff(false),
   bJITBranchOff(false),
   bJITILTimeProfiling(false), bJITILOutputIR(false),
+  bJITPersistentProfile(false), bJITFollowBranches(false), bJITReturnStack(true),
+  bJITSpeculativeCompile(false),
   bFPRF(false),
   bCPUThread(true), bDSPThread(false), bDSPHLE(true),
   m_GPUDeterminismMode(GPU_DETERMINISM_AUTO),
@@ -204,6 +204,10 @@ struct SCoreStartupParameter
 	bool bJITBranchOff;
 	bool bJITILTimeProfiling;
 	bool bJITILOutputIR;
+	bool bJITPersistentProfile;
+	bool bJITFollowBranches;
+	bool bJITReturnStack;
+	bool bJITSpeculativeCompile;
 
 	bool bFastmem;
 	bool bFPRF;
@@ -547,7 +547,11 @@ void SetLidOpen(bool _bOpen)
 
 bool DVDRead(u64 _iDVDOffset, u32 _iRamAddress, u32 _iLength, bool decrypt)
 {
-	return s_inserted_volume->Read(_iDVDOffset, _iLength, Memory::GetPointer(_iRamAddress), decrypt);
+	// The volume may read straight from the disc image into RAM.
+	Memory::BeginUnwatchedWrite(_iRamAddress, _iLength);
+	bool result = s_inserted_volume->Read(_iDVDOffset, _iLength, Memory::GetPointer(_iRamAddress), decrypt);
+	Memory::EndUnwatchedWrite(_iRamAddress, _iLength);
+	return result;
 }
 
 bool ChangePartition(u64 offset)
@@ -8,10 +8,14 @@
 // However, if a JITed instruction (for example lwz) wants to access a bad memory area that call
 // may be redirected here (for example to Read_U32()).
 
+#include <atomic>
+#include <mutex>
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/MemArena.h"
 #include "Common/MemoryUtil.h"
+#include "Common/Thread.h"
 
 #include "Core/ARBruteForcer.h"
 #include "Core/ConfigManager.h"
@@ -212,6 +216,7 @@ void DoState(PointerWrap &p)
 
 void Shutdown()
 {
+	DisableWriteWatch();
 	m_IsInitialized = false;
 	u32 flags = 0;
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii) flags |= MV_WII_ONLY;
@@ -372,4 +377,215 @@ void Write_U64_Swap(u64 value, u32 address)
 	*(u64*)GetPointer(address) = value;
 }
 
+// Write watching. Only MEM1 is covered; the Wii's IOS emulation writes to
+// EXRAM from too many places that the fault handler can't see.
+static const u32 WATCH_PAGE_SHIFT = 12;
+static const u32 WATCH_PAGE_SIZE = 1 << WATCH_PAGE_SHIFT;
+static const u32 WATCH_NUM_PAGES = REALRAM_SIZE >> WATCH_PAGE_SHIFT;
+
+static std::atomic<bool> s_write_watch_enabled(false);
+// Serializes everything but the fault handler, which must not block.
+static std::mutex s_write_watch_lock;
+static std::atomic<u64> s_write_watch_clock;
+static std::atomic<u64> s_page_write_stamp[WATCH_NUM_PAGES];
+// Pages with a write in flight that the handler can't see; never protected.
+static u32 s_page_busy[WATCH_NUM_PAGES];
+
+// Whoever moves a page to PAGE_CHANGING owns it until it stores the new state,
+// so the fault handler and the watching thread never undo each other's
+// (multi-view, thus non-atomic) protection change.
+enum
+{
+	PAGE_UNPROTECTED,
+	PAGE_PROTECTED,
+	PAGE_CHANGING,
+};
+static std::atomic<u8> s_page_state[WATCH_NUM_PAGES];
+
+// Every view backed by the start of the shared memory segment maps MEM1.
+static bool IsRAMView(const MemoryView& view)
+{
+	return view.mapped_ptr && view.shm_position == 0;
+}
+
+static void SetPageProtection(u32 page, bool protect)
+{
+	for (const MemoryView& view : views)
+	{
+		if (!IsRAMView(view))
+			continue;
+
+		u8* ptr = (u8*)view.mapped_ptr + (page << WATCH_PAGE_SHIFT);
+		if (protect)
+			WriteProtectMemory(ptr, WATCH_PAGE_SIZE);
+		else
+			UnWriteProtectMemory(ptr, WATCH_PAGE_SIZE);
+	}
+}
+
+// Only called with s_write_watch_lock held; the fault handler is the only
+// other thread that may own the page, and it never waits for anything.
+static void ChangePageProtection(u32 page, bool protect)
+{
+	const u8 from = protect ? PAGE_UNPROTECTED : PAGE_PROTECTED;
+	while (true)
+	{
+		u8 state = from;
+		if (s_page_state[page].compare_exchange_strong(state, PAGE_CHANGING))
+			break;
+		if (state != PAGE_CHANGING)
+			return;
+		Common::YieldCPU();
+	}
+
+	SetPageProtection(page, protect);
+	s_page_state[page] = protect ? PAGE_PROTECTED : PAGE_UNPROTECTED;
+}
+
+static bool GetWatchedPages(u32 address, u32 size, u32* first_page, u32* last_page)
+{
+	address &= 0x3FFFFFFF;
+	if (size == 0 || address >= REALRAM_SIZE || size > REALRAM_SIZE - address)
+		return false;
+
+	*first_page = address >> WATCH_PAGE_SHIFT;
+	*last_page = (address + size - 1) >> WATCH_PAGE_SHIFT;
+	return true;
+}
+
+bool IsWriteWatchEnabled()
+{
+	return s_write_watch_enabled;
+}
+
+void EnableWriteWatch()
+{
+	// Mach exception ports are per thread, so on OS X writes from the GPU
+	// thread (EFB copies) wouldn't reach the handler.
+#ifndef __APPLE__
+	if (!m_IsInitialized || SConfig::GetInstance().m_LocalCoreStartupParameter.bWii)
+		return;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	s_write_watch_enabled = true;
+#endif
+}
+
+void DisableWriteWatch()
+{
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	if (!s_write_watch_enabled)
+		return;
+
+	// Unprotect everything before the fault handler stops accepting faults.
+	const u64 stamp = ++s_write_watch_clock;
+	for (u32 page = 0; page < WATCH_NUM_PAGES; ++page)
+	{
+		ChangePageProtection(page, false);
+		s_page_write_stamp[page] = stamp;
+	}
+	s_write_watch_enabled = false;
+}
+
+u64 WatchRange(u32 address, u32 size)
+{
+	u32 first_page, last_page;
+	if (!GetWatchedPages(address, size, &first_page, &last_page))
+		return 0;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	if (!s_write_watch_enabled)
+		return 0;
+
+	for (u32 page = first_page; page <= last_page; ++page)
+	{
+		if (s_page_busy[page])
+			return 0;
+	}
+
+	// Anything written after this point faults and gets a newer stamp.
+	for (u32 page = first_page; page <= last_page; ++page)
+		ChangePageProtection(page, true);
+	return ++s_write_watch_clock;
+}
+
+bool IsRangeUnmodified(u32 address, u32 size, u64 stamp)
+{
+	u32 first_page, last_page;
+	if (stamp == 0 || !GetWatchedPages(address, size, &first_page, &last_page))
+		return false;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	if (!s_write_watch_enabled)
+		return false;
+
+	for (u32 page = first_page; page <= last_page; ++page)
+	{
+		if (s_page_busy[page] || s_page_write_stamp[page] >= stamp)
+			return false;
+	}
+	return true;
+}
+
+void BeginUnwatchedWrite(u32 address, u32 size)
+{
+	u32 first_page, last_page;
+	if (!GetWatchedPages(address, size, &first_page, &last_page))
+		return;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	const u64 stamp = ++s_write_watch_clock;
+	for (u32 page = first_page; page <= last_page; ++page)
+	{
+		s_page_busy[page]++;
+		ChangePageProtection(page, false);
+		s_page_write_stamp[page] = stamp;
+	}
+}
+
+void EndUnwatchedWrite(u32 address, u32 size)
+{
+	u32 first_page, last_page;
+	if (!GetWatchedPages(address, size, &first_page, &last_page))
+		return;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	const u64 stamp = ++s_write_watch_clock;
+	for (u32 page = first_page; page <= last_page; ++page)
+	{
+		s_page_busy[page]--;
+		s_page_write_stamp[page] = stamp;
+	}
+}
+
+// Runs in the fault handler, so only atomics may be used here.
+bool HandleWriteWatchFault(uintptr_t access_address)
+{
+	if (!s_write_watch_enabled)
+		return false;
+
+	for (const MemoryView& view : views)
+	{
+		if (!IsRAMView(view))
+			continue;
+
+		uintptr_t base = (uintptr_t)view.mapped_ptr;
+		if (access_address < base || access_address >= base + REALRAM_SIZE)
+			continue;
+
+		// If another thread is changing the page's protection, retrying the
+		// access faults again until it's done.
+		u32 page = (u32)((access_address - base) >> WATCH_PAGE_SHIFT);
+		u8 state = PAGE_PROTECTED;
+		if (s_page_state[page].compare_exchange_strong(state, PAGE_CHANGING))
+		{
+			SetPageProtection(page, false);
+			s_page_write_stamp[page] = ++s_write_watch_clock;
+			s_page_state[page] = PAGE_UNPROTECTED;
+		}
+		return true;
+	}
+	return false;
+}
+
 }  // namespace
@@ -92,4 +92,22 @@ void Write_U64(const u64 var, const u32 address);
 void Write_U32_Swap(const u32 var, const u32 address);
 void Write_U64_Swap(const u64 var, const u32 address);
 
+// Write watching of MEM1, at page granularity. Watched pages are write
+// protected in every view of RAM; the first write to one of them faults, gets
+// recorded and unprotects the page again. This lets consumers of guest memory
+// (e.g. the texture cache) skip rereading data that hasn't changed.
+bool IsWriteWatchEnabled();
+void EnableWriteWatch();
+void DisableWriteWatch();
+// Starts watching the range and returns a stamp for IsRangeUnmodified(), or 0
+// if the range can't be watched. Read the range only after calling this.
+u64 WatchRange(u32 address, u32 size);
+bool IsRangeUnmodified(u32 address, u32 size, u64 stamp);
+// Writes that don't go through the host CPU (e.g. the OS reading a disc image
+// straight into RAM) can't be caught by the fault handler and must be
+// wrapped in these. The range stays unprotected until the write has ended.
+void BeginUnwatchedWrite(u32 address, u32 size);
+void EndUnwatchedWrite(u32 address, u32 size);
+bool HandleWriteWatchFault(uintptr_t access_address);
+
 }
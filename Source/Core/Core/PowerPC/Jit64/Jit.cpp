@@ -190,8 +190,12 @@ void Jit64::Init()
 
 	// BLR optimization has the same consequences as block linking, as well as
 	// depending on the fault handler to be safe in the event of excessive BL.
-	m_enable_blr_optimization = jo.enableBlocklink && SConfig::GetInstance().m_LocalCoreStartupParameter.bFastmem && !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging;
+	// JITReturnStack=False in the ini turns it off, to compare against plain
+	// dispatching when a game misbehaves.
+	m_enable_blr_optimization = jo.enableBlocklink && SConfig::GetInstance().m_LocalCoreStartupParameter.bFastmem && !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging &&
+	                            SConfig::GetInstance().m_LocalCoreStartupParameter.bJITReturnStack;
 	m_clear_cache_asap = false;
+	m_speculative_targets.clear();
 
 	m_stack = nullptr;
 	if (m_enable_blr_optimization)
@@ -200,6 +204,9 @@ void Jit64::Init()
 	blocks.Init();
 	asm_routines.Init(m_stack ? (m_stack + STACK_SIZE) : nullptr);
 
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITPersistentProfile)
+		profile.Init(SConfig::GetInstance().m_LocalCoreStartupParameter.GetUniqueID());
+
 	// important: do this *after* generating the global asm routines, because we can't use farcode in them.
 	// it'll crash because the farcode functions get cleared on JIT clears.
 	farcode.Init(jo.memcheck ? FARCODE_SIZE_MMU : FARCODE_SIZE);
@@ -222,9 +229,15 @@ void Jit64::ClearCache()
 
 void Jit64::Shutdown()
 {
+	if (m_enable_blr_optimization)
+		INFO_LOG(DYNA_REC, "BLR cache: %llu mispredicted returns", (unsigned long long)asm_routines.GetBLRMispredicts());
+
 	FreeStack();
 	FreeCodeSpace();
 
+	profile.Record(blocks);
+	profile.Shutdown();
+
 	blocks.Shutdown();
 	trampolines.Shutdown();
 	asm_routines.Shutdown();
@@ -242,11 +255,25 @@ void Jit64::WriteCallInterpreter(UGeckoInstruction inst)
 		MOV(32, PPCSTATE(npc), Imm32(js.compilerPC + 4));
 	}
 	Interpreter::_interpreterInstruction instr = GetInterpreterOp(inst);
+	IncrementOpCounter(inst, &GekkoOPInfo::fallbackCount, RSCRATCH);
 	ABI_PushRegistersAndAdjustStack({}, 0);
 	ABI_CallFunctionC((void*)instr, inst.hex);
 	ABI_PopRegistersAndAdjustStack({}, 0);
 }
 
+void Jit64::IncrementOpCounter(UGeckoInstruction inst, u64 GekkoOPInfo::*counter, X64Reg scratch)
+{
+	if (!Profiler::g_ProfileBlocks)
+		return;
+
+	GekkoOPInfo* info = GetOpInfo(inst);
+	if (!info)
+		return;
+
+	MOV(64, R(scratch), Imm64((u64)&(info->*counter)));
+	ADD(64, MatR(scratch), Imm8(1));
+}
+
 void Jit64::FallBackToInterpreter(UGeckoInstruction _inst)
 {
 	WriteCallInterpreter(_inst.hex);
@@ -374,11 +401,17 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
 }
 
 void Jit64::WriteExitDestInRSCRATCH(bool bl, u32 after)
+{
+	WriteExitDestInRSCRATCH(js.op->inst, bl, after);
+}
+
+void Jit64::WriteExitDestInRSCRATCH(UGeckoInstruction inst, bool bl, u32 after)
 {
 	if (!m_enable_blr_optimization)
 		bl = false;
 	MOV(32, PPCSTATE(pc), R(RSCRATCH));
 	Cleanup();
+	IncrementOpCounter(inst, &GekkoOPInfo::dispatcherExitCount, RSCRATCH2);
 
 	if (bl)
 	{
@@ -400,10 +433,15 @@ void Jit64::WriteExitDestInRSCRATCH(bool bl, u32 after)
 }
 
 void Jit64::WriteBLRExit()
+{
+	WriteBLRExit(js.op->inst);
+}
+
+void Jit64::WriteBLRExit(UGeckoInstruction inst)
 {
 	if (!m_enable_blr_optimization)
 	{
-		WriteExitDestInRSCRATCH();
+		WriteExitDestInRSCRATCH(inst, false, 0);
 		return;
 	}
 	MOV(32, PPCSTATE(pc), R(RSCRATCH));
@@ -422,6 +460,7 @@ void Jit64::WriteRfiExitDestInRSCRATCH()
 	MOV(32, PPCSTATE(pc), R(RSCRATCH));
 	MOV(32, PPCSTATE(npc), R(RSCRATCH));
 	Cleanup();
+	IncrementOpCounter(js.op->inst, &GekkoOPInfo::dispatcherExitCount, RSCRATCH);
 	ABI_PushRegistersAndAdjustStack({}, 0);
 	ABI_CallFunction(reinterpret_cast<void *>(&PowerPC::CheckExceptions));
 	ABI_PopRegistersAndAdjustStack({}, 0);
@@ -432,6 +471,7 @@ void Jit64::WriteRfiExitDestInRSCRATCH()
 void Jit64::WriteExceptionExit()
 {
 	Cleanup();
+	IncrementOpCounter(js.op->inst, &GekkoOPInfo::exceptionExitCount, RSCRATCH);
 	MOV(32, R(RSCRATCH), PPCSTATE(pc));
 	MOV(32, PPCSTATE(npc), R(RSCRATCH));
 	ABI_PushRegistersAndAdjustStack({}, 0);
@@ -444,6 +484,7 @@ void Jit64::WriteExceptionExit()
 void Jit64::WriteExternalExceptionExit()
 {
 	Cleanup();
+	IncrementOpCounter(js.op->inst, &GekkoOPInfo::exceptionExitCount, RSCRATCH);
 	MOV(32, R(RSCRATCH), PPCSTATE(pc));
 	MOV(32, PPCSTATE(npc), R(RSCRATCH));
 	ABI_PushRegistersAndAdjustStack({}, 0);
@@ -521,6 +562,7 @@ void Jit64::Jit(u32 em_address)
 				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_MERGE);
 				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
 				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
+				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
 			}
 			Trace();
 		}
@@ -540,9 +582,125 @@ void Jit64::Jit(u32 em_address)
 		return;
 	}
 
+	JitBlock* b = CompileBlock(em_address, nextPC);
+
+	// Block misses are where the CPU thread is stalled by compiling anyway, so
+	// use them to catch up on blocks which were hot in earlier sessions.
+	if (profile.HasPendingBlocks() && !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
+		CompileProfiledBlocks();
+
+	// ...and on blocks this one is likely to branch to next.
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITSpeculativeCompile &&
+	    !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
+	{
+		QueueSpeculativeTargets(b);
+		CompileSpeculativeBlocks();
+	}
+}
+
+JitBlock* Jit64::CompileBlock(u32 em_address, u32 nextPC)
+{
 	int block_num = blocks.AllocateBlock(em_address);
 	JitBlock *b = blocks.GetBlock(block_num);
+	if (profile.IsRecording())
+	{
+		b->codeHash = JitProfile::HashCode(code_buffer, code_block.m_num_instructions);
+		b->firstInstruction = code_buffer.codebuffer[0].inst.hex;
+		b->msrBits = JitProfile::GetMSRBits();
+	}
 	blocks.FinalizeBlock(block_num, jo.enableBlocklink, DoJit(em_address, &code_buffer, b, nextPC));
+	return b;
+}
+
+void Jit64::CompileProfiledBlocks()
+{
+	// Compile only a few blocks per miss, so that loading a large profile
+	// doesn't turn into one long stall.
+	const int MAX_BLOCKS_PER_MISS = 4;
+
+	u32 address, hash;
+	for (int i = 0; i < MAX_BLOCKS_PER_MISS && profile.GetNextPendingBlock(&address, &hash); i++)
+	{
+		// Never clear the cache for a block that might not run
+		if (GetSpaceLeft() < 0x20000 ||
+		    farcode.GetSpaceLeft() < 0x20000 ||
+		    trampolines.GetSpaceLeft() < 0x20000 ||
+		    blocks.IsFull() ||
+		    m_clear_cache_asap)
+			return;
+
+		if (blocks.GetBlockNumberFromStartAddress(address) != -1)
+		{
+			profile.RemovePendingBlock();
+			continue;
+		}
+
+		// The same checks as for a regular block: the code has to be translatable,
+		// and it has to be exactly the code the profile was recorded with. If it
+		// isn't, drop the block instead of analyzing it again on every miss.
+		u32 nextPC = analyzer.Analyze(address, &code_block, &code_buffer, code_buffer.GetSize());
+		if (code_block.m_memory_exception || code_block.m_num_instructions == 0 ||
+		    JitProfile::HashCode(code_buffer, code_block.m_num_instructions) != hash)
+		{
+			profile.RemovePendingBlock();
+			continue;
+		}
+
+		profile.RemovePendingBlock();
+		CompileBlock(address, nextPC);
+	}
+}
+
+void Jit64::QueueSpeculativeTargets(const JitBlock* b)
+{
+	// Bounds the work queued up by a burst of misses, e.g. while a level loads
+	const size_t MAX_QUEUED_TARGETS = 1024;
+
+	// Unlinked exits are exactly the direct branch targets which have no block yet
+	for (const auto& e : b->linkData)
+	{
+		if (!e.linkStatus)
+			m_speculative_targets.push_back(e.exitAddress);
+	}
+
+	while (m_speculative_targets.size() > MAX_QUEUED_TARGETS)
+		m_speculative_targets.pop_front();
+}
+
+void Jit64::CompileSpeculativeBlocks()
+{
+	// Like CompileProfiledBlocks, keep the extra work per miss small.
+	const int MAX_BLOCKS_PER_MISS = 4;
+
+	for (int i = 0; i < MAX_BLOCKS_PER_MISS && !m_speculative_targets.empty(); )
+	{
+		// Newest first, so that we follow the code that is running right now
+		u32 address = m_speculative_targets.back();
+		m_speculative_targets.pop_back();
+
+		// Never clear the cache for a block that might not run
+		if (GetSpaceLeft() < 0x20000 ||
+		    farcode.GetSpaceLeft() < 0x20000 ||
+		    trampolines.GetSpaceLeft() < 0x20000 ||
+		    blocks.IsFull() ||
+		    m_clear_cache_asap)
+		{
+			m_speculative_targets.clear();
+			return;
+		}
+
+		if (blocks.GetBlockNumberFromStartAddress(address) != -1)
+			continue;
+
+		// The target might not be mapped yet, or might not even be code. In both
+		// cases the block is simply compiled again when execution gets there.
+		u32 nextPC = analyzer.Analyze(address, &code_block, &code_buffer, code_buffer.GetSize());
+		if (code_block.m_memory_exception || code_block.m_num_instructions == 0)
+			continue;
+
+		QueueSpeculativeTargets(CompileBlock(address, nextPC));
+		i++;
+	}
 }
 
 const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBlock *b, u32 nextPC)
@@ -588,6 +746,12 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 		// get start tic
 		PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStart);
 	}
+	else if (profile.IsRecording())
+	{
+		// Only count block entries for the persistent JIT profile
+		MOV(64, R(RSCRATCH), Imm64((u64)&b->runCount));
+		ADD(32, MatR(RSCRATCH), Imm8(1));
+	}
 #if defined(_DEBUG) || defined(DEBUGFAST) || defined(NAN_CHECK)
 	// should help logged stack-traces become more accurate
 	MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
@@ -861,6 +1025,11 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 
 	b->codeSize = (u32)(GetCodePtr() - normalEntry);
 	b->originalSize = code_block.m_num_instructions;
+	if (code_block.m_ranges.size() > 1)
+	{
+		b->originalSize = code_block.m_ranges[0].second;
+		b->followedRanges.assign(code_block.m_ranges.begin() + 1, code_block.m_ranges.end());
+	}
 
 #ifdef JIT_LOG_X86
 	LogGeneratedX86(code_block.m_num_instructions, code_buf, normalEntry, b);
@@ -895,4 +1064,8 @@ void Jit64::EnableOptimization()
 	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_MERGE);
 	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
 	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
+	// Followed branches are skipped by Jit64::bx, which the interpreter fallback can't do
+	const SCoreStartupParameter& startup = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	if (startup.bJITFollowBranches && !startup.bJITOff && !startup.bJITBranchOff)
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
 }
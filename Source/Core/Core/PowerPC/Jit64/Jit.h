@@ -18,6 +18,8 @@
 // ----------
 #pragma once
 
+#include <deque>
+
 #include "Common/x64ABI.h"
 #include "Common/x64Analyzer.h"
 #include "Common/x64Emitter.h"
@@ -54,6 +56,9 @@ private:
 	bool m_clear_cache_asap;
 	u8* m_stack;
 
+	// Exit targets of recently compiled blocks which aren't compiled yet
+	std::deque<u32> m_speculative_targets;
+
 public:
 	Jit64() : code_buffer(32000) {}
 	~Jit64() {}
@@ -72,6 +77,14 @@ public:
 
 	void Jit(u32 em_address) override;
 	const u8* DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBlock *b, u32 nextPC);
+	JitBlock* CompileBlock(u32 em_address, u32 nextPC);
+	void CompileProfiledBlocks();
+	void QueueSpeculativeTargets(const JitBlock* b);
+	void CompileSpeculativeBlocks();
+
+	// Emits an increment of one of the GekkoOPInfo counters of inst if blocks are
+	// being profiled. Changes the flags, so it has to come before the downcount update.
+	void IncrementOpCounter(UGeckoInstruction inst, u64 GekkoOPInfo::*counter, Gen::X64Reg scratch);
 
 	BitSet32 CallerSavedRegistersInUse();
 
@@ -101,6 +114,10 @@ public:
 	void JustWriteExit(u32 destination, bool bl, u32 after);
 	void WriteExitDestInRSCRATCH(bool bl = false, u32 after = 0);
 	void WriteBLRExit();
+	// For exits of a branch merged into the current instruction, which the
+	// exit is counted against when profiling.
+	void WriteExitDestInRSCRATCH(UGeckoInstruction inst, bool bl, u32 after);
+	void WriteBLRExit(UGeckoInstruction inst);
 	void WriteExceptionExit();
 	void WriteExternalExceptionExit();
 	void WriteRfiExitDestInRSCRATCH();
@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <cstddef>
+
 #include "Common/JitRegister.h"
 #include "Common/MemoryUtil.h"
 
@@ -12,13 +14,20 @@ using namespace Gen;
 
 // Not PowerPC state.  Can't put in 'this' because it's out of range...
 static void* s_saved_rsp;
+static u64 s_blr_mispredicts;
 
 // PLAN: no more block numbers - crazy opcodes just contain offset within
 // dynarec buffer
 // At this offset - 4, there is an int specifying the block number.
 
+u64 Jit64AsmRoutineManager::GetBLRMispredicts() const
+{
+	return s_blr_mispredicts;
+}
+
 void Jit64AsmRoutineManager::Generate()
 {
+	s_blr_mispredicts = 0;
 	enterCode = AlignCode16();
 	// We need to own the beginning of RSP, so we do an extra stack adjustment
 	// for the shadow region before calls in this function.  This call will
@@ -48,6 +57,7 @@ void Jit64AsmRoutineManager::Generate()
 		ABI_PopRegistersAndAdjustStack({}, 0);
 		FixupBranch skipToRealDispatch = J(SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging); //skip the sync and compare first time
 		dispatcherMispredictedBLR = GetCodePtr();
+		ADD(64, M(&s_blr_mispredicts), Imm8(1));
 		AND(32, PPCSTATE(pc), Imm32(0xFFFFFFFC));
 
 		#if 0 // debug mispredicts
@@ -97,6 +107,26 @@ void Jit64AsmRoutineManager::Generate()
 
 			MOV(32, R(RSCRATCH), PPCSTATE(pc));
 
+			// Probe the fast lookup table first. RSCRATCH_EXTRA keeps pointing at the
+			// entry, so the iCache path below can refill it on a hit.
+			u64 fastLookup = (u64)jit->GetBlockCache()->fastLookup.data();
+			static_assert(sizeof(JitFastLookupEntry) == 16, "The dispatcher assumes 16 byte fast lookup entries");
+			MOV(32, R(RSCRATCH2), R(RSCRATCH));
+			AND(32, R(RSCRATCH2), Imm32(JIT_FAST_LOOKUP_MASK << 2));
+			if (fastLookup <= INT_MAX)
+			{
+				LEA(64, RSCRATCH_EXTRA, MScaled(RSCRATCH2, SCALE_4, (s32)fastLookup));
+			}
+			else
+			{
+				MOV(64, R(RSCRATCH_EXTRA), Imm64(fastLookup));
+				LEA(64, RSCRATCH_EXTRA, MComplex(RSCRATCH_EXTRA, RSCRATCH2, SCALE_4, 0));
+			}
+			CMP(32, R(RSCRATCH), MatR(RSCRATCH_EXTRA));
+			FixupBranch fast_miss = J_CC(CC_NZ);
+			JMPptr(MDisp(RSCRATCH_EXTRA, offsetof(JitFastLookupEntry, code)));
+			SetJumpTarget(fast_miss);
+
 			// TODO: We need to handle code which executes the same PC with
 			// different values of MSR.IR. It probably makes sense to handle
 			// MSR.DR here too, to allow IsOptimizableRAMAddress-based
@@ -172,13 +202,18 @@ void Jit64AsmRoutineManager::Generate()
 			u64 codePointers = (u64)jit->GetBlockCache()->GetCodePointers();
 			if (codePointers <= INT_MAX)
 			{
-				JMPptr(MScaled(RSCRATCH, SCALE_8, (s32)codePointers));
+				MOV(64, R(RSCRATCH), MScaled(RSCRATCH, SCALE_8, (s32)codePointers));
 			}
 			else
 			{
 				MOV(64, R(RSCRATCH2), Imm64(codePointers));
-				JMPptr(MComplex(RSCRATCH2, RSCRATCH, SCALE_8, 0));
+				MOV(64, R(RSCRATCH), MComplex(RSCRATCH2, RSCRATCH, SCALE_8, 0));
 			}
+			// Remember the block in the fast lookup table for next time
+			MOV(32, R(RSCRATCH2), PPCSTATE(pc));
+			MOV(32, MatR(RSCRATCH_EXTRA), R(RSCRATCH2));
+			MOV(64, MDisp(RSCRATCH_EXTRA, offsetof(JitFastLookupEntry, code)), R(RSCRATCH));
+			JMPptr(R(RSCRATCH));
 			SetJumpTarget(notfound);
 
 			//Ok, no block, let's jit
@@ -43,4 +43,8 @@ public:
 	{
 		FreeCodeSpace();
 	}
+
+	// Number of blr whose target didn't match the return address the
+	// corresponding bl pushed, since the last Init
+	u64 GetBLRMispredicts() const;
 };
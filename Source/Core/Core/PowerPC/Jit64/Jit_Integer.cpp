@@ -366,7 +366,7 @@ void Jit64::DoMergedBranch()
 			MOV(32, M(&LR), Imm32(nextPC + 4));
 		MOV(32, R(RSCRATCH), M(&CTR));
 		AND(32, R(RSCRATCH), Imm32(0xFFFFFFFC));
-		WriteExitDestInRSCRATCH(next.LK, nextPC + 4);
+		WriteExitDestInRSCRATCH(next, next.LK, nextPC + 4);
 	}
 	else if ((next.OPCD == 19) && (next.SUBOP10 == 16)) // bclrx
 	{
@@ -375,7 +375,7 @@ void Jit64::DoMergedBranch()
 			AND(32, R(RSCRATCH), Imm32(0xFFFFFFFC));
 		if (next.LK)
 			MOV(32, M(&LR), Imm32(nextPC + 4));
-		WriteBLRExit();
+		WriteBLRExit(next);
 	}
 	else
 	{
@@ -26,6 +26,7 @@
 #include "Core/PowerPC/Jit64Common/Jit64AsmCommon.h"
 #include "Core/PowerPC/JitCommon/Jit_Util.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
+#include "Core/PowerPC/JitCommon/JitProfile.h"
 #include "Core/PowerPC/JitCommon/TrampolineCache.h"
 
 // TODO: find a better place for x86-specific stuff
@@ -117,6 +118,7 @@ public:
 	// This should probably be removed from public:
 	JitOptions jo;
 	JitState js;
+	JitProfile profile;
 
 	virtual JitBaseBlockCache *GetBlockCache() = 0;
 
@@ -9,6 +9,8 @@
 // performance hit, it's not enabled by default, but it's useful for
 // locating performance issues.
 
+#include <algorithm>
+
 #include "disasm.h"
 
 #include "Common/CommonTypes.h"
@@ -66,17 +68,21 @@ using namespace Gen;
 #endif
 		jit->js.fifoWriteAddresses.clear();
 		jit->js.pairedQuantizeAddresses.clear();
+		jit->profile.Record(*this);
 		for (int i = 0; i < num_blocks; i++)
 		{
 			DestroyBlock(i, false);
 		}
 		links_to.clear();
 		block_map.clear();
+		followed_ranges.clear();
+		max_followed_range_size = 0;
 
 		valid_block.ClearAll();
 
 		num_blocks = 0;
 		blockCodePointers.fill(nullptr);
+		fastLookup.fill(JitFastLookupEntry{ JIT_FAST_LOOKUP_INVALID, 0, nullptr });
 	}
 
 	void JitBaseBlockCache::Reset()
@@ -113,6 +119,7 @@ using namespace Gen;
 		b.invalid = false;
 		b.originalAddress = em_address;
 		b.linkData.clear();
+		b.followedRanges.clear();
 		num_blocks++; //commit the current block
 		return num_blocks - 1;
 	}
@@ -124,6 +131,10 @@ using namespace Gen;
 		u32* icp = GetICachePtr(b.originalAddress);
 		*icp = block_num;
 
+		JitFastLookupEntry& entry = fastLookup[(b.originalAddress >> 2) & JIT_FAST_LOOKUP_MASK];
+		entry.address = b.originalAddress;
+		entry.code = code_ptr;
+
 		// Convert the logical address to a physical address for the block map
 		u32 pAddr = b.originalAddress & 0x1FFFFFFF;
 
@@ -132,6 +143,18 @@ using namespace Gen;
 
 		block_map[std::make_pair(pAddr + 4 * b.originalSize - 1, pAddr)] = block_num;
 
+		// The code of followed branches has to invalidate the block as well
+		for (const auto& range : b.followedRanges)
+		{
+			u32 start = range.first & 0x1FFFFFFF;
+			u32 end = start + 4 * range.second;
+			for (u32 block = start / 32; block <= (end - 1) / 32; ++block)
+				valid_block.Set(block);
+
+			followed_ranges.emplace(start, std::make_pair(end, block_num));
+			max_followed_range_size = std::max(max_followed_range_size, end - start);
+		}
+
 		if (block_link)
 		{
 			for (const auto& e : b.linkData)
@@ -265,6 +288,11 @@ using namespace Gen;
 		b.invalid = true;
 		*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
 
+		// The dispatcher jumps to normalEntry, which WriteDestroyBlock doesn't patch
+		JitFastLookupEntry& entry = fastLookup[(b.originalAddress >> 2) & JIT_FAST_LOOKUP_MASK];
+		if (entry.code == blockCodePointers[block_num])
+			entry.address = JIT_FAST_LOOKUP_INVALID;
+
 		UnlinkBlock(block_num);
 
 		// Send anyone who tries to run this block back to the dispatcher.
@@ -305,6 +333,30 @@ using namespace Gen;
 				block_map.erase(it1, it2);
 			}
 
+			// Blocks which continue into the range by following a branch
+			u32 search_start = pAddr >= max_followed_range_size ? pAddr - max_followed_range_size : 0;
+			auto it3 = followed_ranges.lower_bound(search_start);
+			while (it3 != followed_ranges.end() && it3->first < pAddr + length)
+			{
+				if (it3->second.first <= pAddr)
+				{
+					++it3;
+					continue;
+				}
+
+				int block_num = it3->second.second;
+				JitBlock &b = blocks[block_num];
+				if (!b.invalid)
+				{
+					u32 start = b.originalAddress & 0x1FFFFFFF;
+					auto main_range = block_map.find(std::make_pair(start + 4 * b.originalSize - 1, start));
+					if (main_range != block_map.end() && main_range->second == (u32)block_num)
+						block_map.erase(main_range);
+					DestroyBlock(block_num, true);
+				}
+				it3 = followed_ranges.erase(it3);
+			}
+
 			// If the code was actually modified, we need to clear the relevant entries from the
 			// FIFO write address cache, so we don't end up with FIFO checks in places they shouldn't
 			// be (this can clobber flags, and thus break any optimization that relies on flags
@@ -27,6 +27,12 @@
 #define JIT_ICACHE_INVALID_BYTE 0x80
 #define JIT_ICACHE_INVALID_WORD 0x80808080
 
+// Direct-mapped table probed inline by the dispatcher before the iCache lookup
+#define JIT_FAST_LOOKUP_SIZE 0x10000
+#define JIT_FAST_LOOKUP_MASK 0xffff
+// Never matches, since instruction addresses are word aligned
+#define JIT_FAST_LOOKUP_INVALID 0xffffffff
+
 struct JitBlock
 {
 	const u8 *checkedEntry;
@@ -35,8 +41,16 @@ struct JitBlock
 	u32 originalAddress;
 	u32 codeSize;
 	u32 originalSize;
+	// Code compiled into the block by following branches, as (address, number of instructions).
+	// originalSize only covers the range starting at originalAddress then.
+	std::vector<std::pair<u32, u32>> followedRanges;
 	int runCount;  // for profiling.
 
+	// Identify the block in the persistent JIT profile
+	u32 codeHash;
+	u32 firstInstruction;
+	u32 msrBits;
+
 	bool invalid;
 
 	struct LinkData
@@ -95,6 +109,13 @@ public:
 	}
 };
 
+struct JitFastLookupEntry
+{
+	u32 address;
+	u32 padding;
+	const u8 *code;
+};
+
 class JitBaseBlockCache
 {
 	enum
@@ -107,6 +128,8 @@ class JitBaseBlockCache
 	int num_blocks;
 	std::multimap<u32, int> links_to;
 	std::map<std::pair<u32, u32>, u32> block_map; // (end_addr, start_addr) -> number
+	std::multimap<u32, std::pair<u32, int>> followed_ranges; // start_addr -> (end_addr, number)
+	u32 max_followed_range_size;
 	ValidBlockBitSet valid_block;
 
 	bool m_initialized;
@@ -124,7 +147,7 @@ class JitBaseBlockCache
 	virtual void WriteDestroyBlock(const u8* location, u32 address) = 0;
 
 public:
-	JitBaseBlockCache() : num_blocks(0), m_initialized(false)
+	JitBaseBlockCache() : num_blocks(0), max_followed_range_size(0), m_initialized(false)
 	{
 	}
 
@@ -149,6 +172,9 @@ public:
 	std::array<u8, JIT_ICACHE_SIZE>   iCache;
 	std::array<u8, JIT_ICACHEEX_SIZE> iCacheEx;
 	std::array<u8, JIT_ICACHE_SIZE>   iCacheVMEM;
+	// Indexed by (address >> 2) & JIT_FAST_LOOKUP_MASK. Filled by FinalizeBlock
+	// and by the dispatcher when it had to fall back to the iCache lookup.
+	std::array<JitFastLookupEntry, JIT_FAST_LOOKUP_SIZE> fastLookup;
 
 	// Fast way to get a block. Only works on the first ppc instruction of a block.
 	int GetBlockNumberFromStartAddress(u32 em_address);
@@ -0,0 +1,198 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+#include "Core/PowerPC/JitCommon/JitProfile.h"
+
+static const u32 JIT_PROFILE_MAGIC = 0x464F5250; // "PROF"
+static const u32 JIT_PROFILE_VERSION = 1;
+
+// Blocks entered less often than this aren't worth remembering
+static const u64 MIN_RUN_COUNT = 64;
+static const size_t MAX_ENTRIES = 16384;
+// How many pending blocks GetNextPendingBlock looks at per call
+static const size_t MAX_CHECKS_PER_CALL = 16;
+
+JitProfile::JitProfile()
+	: m_recording(false), m_pending_cursor(0), m_returned_index((size_t)-1)
+{
+}
+
+void JitProfile::Init(const std::string& game_id)
+{
+	m_entries.clear();
+	m_pending.clear();
+	m_pending_cursor = 0;
+	m_returned_index = (size_t)-1;
+	m_recording = !game_id.empty();
+	if (!m_recording)
+		return;
+
+	m_filename = File::GetUserPath(D_CACHE_IDX) + "JitProfile" DIR_SEP + game_id + ".prof";
+	Load();
+}
+
+void JitProfile::Shutdown()
+{
+	if (m_recording)
+		Save();
+
+	m_recording = false;
+	m_entries.clear();
+	m_pending.clear();
+	m_pending_cursor = 0;
+	m_returned_index = (size_t)-1;
+}
+
+void JitProfile::Record(JitBaseBlockCache& cache)
+{
+	if (!m_recording)
+		return;
+
+	for (int i = 0; i < cache.GetNumBlocks(); i++)
+	{
+		JitBlock* b = cache.GetBlock(i);
+		if (b->invalid || b->runCount <= 0)
+			continue;
+
+		RecordBlock(b->originalAddress, b->firstInstruction, b->codeHash, b->msrBits, b->runCount);
+		b->runCount = 0;
+	}
+}
+
+void JitProfile::RecordBlock(u32 address, u32 first_instruction, u32 hash, u32 msr_bits, u64 run_count)
+{
+	auto it = m_entries.emplace(std::make_pair(address, hash),
+		Entry{ address, first_instruction, hash, msr_bits, 0 }).first;
+	it->second.run_count += run_count;
+}
+
+bool JitProfile::GetNextPendingBlock(u32* address, u32* hash, CodeCheck is_loaded)
+{
+	const u32 msr_bits = GetMSRBits();
+	for (size_t checks = 0; checks < MAX_CHECKS_PER_CALL && !m_pending.empty(); checks++)
+	{
+		if (m_pending_cursor >= m_pending.size())
+			m_pending_cursor = 0;
+
+		const Entry& entry = m_pending[m_pending_cursor];
+		if (entry.msr_bits == msr_bits && is_loaded(entry.address, entry.first_instruction))
+		{
+			*address = entry.address;
+			*hash = entry.hash;
+			m_returned_index = m_pending_cursor++;
+			return true;
+		}
+
+		// Not loaded yet, try again on a later call
+		m_pending_cursor++;
+	}
+	return false;
+}
+
+void JitProfile::RemovePendingBlock()
+{
+	if (m_returned_index >= m_pending.size())
+		return;
+
+	m_pending.erase(m_pending.begin() + m_returned_index);
+	if (m_returned_index < m_pending_cursor)
+		m_pending_cursor--;
+	m_returned_index = (size_t)-1;
+}
+
+bool JitProfile::IsCodeLoaded(u32 address, u32 first_instruction)
+{
+	return PowerPC::HostIsRAMAddress(address) && PowerPC::HostRead_U32(address) == first_instruction;
+}
+
+u32 JitProfile::HashCode(const PPCAnalyst::CodeBuffer& code_buffer, u32 num_instructions)
+{
+	std::vector<u32> words(num_instructions * 2);
+	for (u32 i = 0; i < num_instructions; i++)
+	{
+		words[i * 2] = code_buffer.codebuffer[i].address;
+		words[i * 2 + 1] = code_buffer.codebuffer[i].inst.hex;
+	}
+	return HashAdler32(reinterpret_cast<const u8*>(words.data()), words.size() * sizeof(u32));
+}
+
+u32 JitProfile::GetMSRBits()
+{
+	UReg_MSR msr(MSR);
+	return (msr.IR << 1) | msr.DR;
+}
+
+void JitProfile::Load()
+{
+	File::IOFile file(m_filename, "rb");
+	if (!file)
+		return;
+
+	u32 header[3];
+	if (!file.ReadArray(header, 3) || header[0] != JIT_PROFILE_MAGIC || header[1] != JIT_PROFILE_VERSION)
+	{
+		WARN_LOG(DYNA_REC, "Ignoring outdated JIT profile %s", m_filename.c_str());
+		return;
+	}
+
+	std::vector<Entry> entries(std::min<size_t>(header[2], MAX_ENTRIES));
+	if (!file.ReadArray(entries.data(), entries.size()))
+	{
+		WARN_LOG(DYNA_REC, "Ignoring truncated JIT profile %s", m_filename.c_str());
+		return;
+	}
+
+	for (Entry& entry : entries)
+	{
+		// Let old sessions count less, so blocks that aren't hot anymore drop out eventually.
+		entry.run_count /= 2;
+		m_entries.emplace(std::make_pair(entry.address, entry.hash), entry);
+	}
+
+	m_pending = std::move(entries);
+	std::stable_sort(m_pending.begin(), m_pending.end(),
+		[](const Entry& a, const Entry& b) { return a.run_count > b.run_count; });
+
+	INFO_LOG(DYNA_REC, "Loaded %u blocks from JIT profile %s", (u32)m_pending.size(), m_filename.c_str());
+}
+
+void JitProfile::Save()
+{
+	std::vector<Entry> entries;
+	entries.reserve(m_entries.size());
+	for (const auto& it : m_entries)
+	{
+		if (it.second.run_count >= MIN_RUN_COUNT)
+			entries.push_back(it.second);
+	}
+
+	std::sort(entries.begin(), entries.end(),
+		[](const Entry& a, const Entry& b) { return a.run_count > b.run_count; });
+	if (entries.size() > MAX_ENTRIES)
+		entries.resize(MAX_ENTRIES);
+
+	if (!File::CreateFullPath(m_filename))
+		return;
+
+	File::IOFile file(m_filename, "wb");
+	if (!file)
+	{
+		ERROR_LOG(DYNA_REC, "Failed to write JIT profile %s", m_filename.c_str());
+		return;
+	}
+
+	const u32 header[3] = { JIT_PROFILE_MAGIC, JIT_PROFILE_VERSION, (u32)entries.size() };
+	file.WriteArray(header, 3);
+	file.WriteArray(entries.data(), entries.size());
+}
@@ -0,0 +1,76 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+class JitBaseBlockCache;
+namespace PPCAnalyst { class CodeBuffer; }
+
+// Remembers which blocks of a game were hot in earlier sessions, so that the
+// JIT can compile them as soon as their code is in memory instead of when
+// they are first executed, which tends to be in the middle of a level load.
+class JitProfile
+{
+public:
+	JitProfile();
+
+	void Init(const std::string& game_id);
+	void Shutdown();
+
+	bool IsRecording() const { return m_recording; }
+
+	// Adds up the run counts of all valid blocks in the cache. Has to be called
+	// before the cache is cleared.
+	void Record(JitBaseBlockCache& cache);
+	void RecordBlock(u32 address, u32 first_instruction, u32 hash, u32 msr_bits, u64 run_count);
+
+	bool HasPendingBlocks() const { return !m_pending.empty(); }
+
+	// Returns a profiled block which hasn't been compiled yet and whose first
+	// instruction is in memory, or false if there is none. Only a few blocks
+	// are checked per call to keep block misses cheap. The caller has to verify
+	// the hash of the analyzed block before compiling it, and then remove it.
+	// is_loaded tells whether the code of a block is in memory.
+	typedef bool (*CodeCheck)(u32 address, u32 first_instruction);
+	bool GetNextPendingBlock(u32* address, u32* hash, CodeCheck is_loaded = IsCodeLoaded);
+	void RemovePendingBlock();
+
+	static bool IsCodeLoaded(u32 address, u32 first_instruction);
+
+	// Identifies the code a block was compiled from, including inlined code
+	static u32 HashCode(const PPCAnalyst::CodeBuffer& code_buffer, u32 num_instructions);
+	// MSR bits which change how the instructions of a block are fetched
+	static u32 GetMSRBits();
+
+private:
+	struct Entry
+	{
+		u32 address;
+		u32 first_instruction;
+		u32 hash;
+		u32 msr_bits;
+		u64 run_count;
+	};
+
+	void Load();
+	void Save();
+
+	std::string m_filename;
+	bool m_recording;
+
+	// (address, hash) -> entry, so that overlays at the same address are kept apart
+	std::map<std::pair<u32, u32>, Entry> m_entries;
+
+	// Blocks of the loaded profile which haven't been compiled yet, hottest first
+	std::vector<Entry> m_pending;
+	size_t m_pending_cursor;
+	size_t m_returned_index;
+};
@@ -164,6 +164,10 @@ namespace JitInterface
 	}
 	bool HandleFault(uintptr_t access_address, SContext* ctx)
 	{
+		// Writes to pages watched for the texture cache aren't JIT faults.
+		if (Memory::HandleWriteWatchFault(access_address))
+			return true;
+
 		return jit->HandleFault(access_address, ctx);
 	}
 
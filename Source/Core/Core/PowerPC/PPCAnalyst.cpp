@@ -642,6 +642,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 	block->m_memory_exception = false;
 	block->m_num_instructions = 0;
 	block->m_gqr_used = BitSet8(0);
+	block->m_ranges.clear();
 
 	CodeOp *code = buffer->codebuffer;
 
@@ -650,6 +651,8 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 	u32 numFollows = 0;
 	u32 num_inst = 0;
 	bool prev_inst_from_bat = true;
+	u32 range_start = address;
+	bool followed_branch = false;
 
 	for (u32 i = 0; i < blockSize; ++i)
 	{
@@ -662,6 +665,11 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 		}
 		UGeckoInstruction inst = result.hex;
 
+		// Only follow branches within BAT mapped code, for the same reason as below.
+		if (followed_branch && !result.from_bat)
+			break;
+		followed_branch = false;
+
 		// Slight hack: the JIT block cache currently assumes all blocks end at the same place,
 		// but broken blocks due to page faults break this assumption. Avoid this by just ending
 		// all virtual memory instruction blocks at page boundaries.
@@ -767,6 +775,30 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 			}
 		}
 
+		if (HasOption(OPTION_BRANCH_FOLLOW) && !follow && inst.OPCD == 18 && !inst.LK &&
+		    result.from_bat && numFollows < FUNCTION_FOLLOWING_THRESHOLD)
+		{
+			const u32 target = inst.AA ? SignExt26(inst.LI << 2) : address + SignExt26(inst.LI << 2);
+
+			// Leave loops to block linking, instead of unrolling them into the block.
+			bool in_block = target >= range_start && target <= address;
+			for (const auto& range : block->m_ranges)
+				in_block |= target >= range.first && target < range.first + range.second * 4;
+
+			if (!in_block)
+			{
+				// The branch doesn't leave the block anymore, which lets the flag and
+				// register analysis below look across it.
+				code[i].canEndBlock = false;
+				block->m_ranges.emplace_back(range_start, (address + 4 - range_start) / 4);
+				range_start = target;
+				address = target;
+				followed_branch = true;
+				numFollows++;
+				continue;
+			}
+		}
+
 		if (!follow)
 		{
 			address += 4;
@@ -791,6 +823,8 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 	}
 
 	block->m_num_instructions = num_inst;
+	if (address != range_start)
+		block->m_ranges.emplace_back(range_start, (address - range_start) / 4);
 
 	if (block->m_num_instructions > 1)
 		ReorderInstructions(block->m_num_instructions, code);
@@ -160,6 +160,10 @@ struct CodeBlock
 
 	// Which GQRs this block modifies, if any.
 	BitSet8 m_gqr_modified;
+
+	// Contiguous ranges of code the block was built from, as (address, number of instructions).
+	// There is more than one range if branches were followed.
+	std::vector<std::pair<u32, u32>> m_ranges;
 };
 
 class PPCAnalyzer
@@ -217,6 +221,11 @@ public:
 
 		// Reorder cror instructions next to their associated fcmp.
 		OPTION_CROR_MERGE =  (1 << 6),
+
+		// Continue the block at the destination of unconditional branches (but not calls),
+		// so that chains of blocks become one superblock without exits in between.
+		// Requires JIT support for branches which aren't the last instruction of a block.
+		OPTION_BRANCH_FOLLOW = (1 << 7),
 	};
 
 
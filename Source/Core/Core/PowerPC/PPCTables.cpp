@@ -203,4 +203,53 @@ void LogCompiledInstructions()
 	++time;
 }
 
+static u64 JitCounterSum(const GekkoOPInfo* info)
+{
+	return info->fallbackCount + info->exceptionExitCount + info->dispatcherExitCount;
+}
+
+void ResetJitCounters()
+{
+	for (int i = 0; i < m_numInstructions; i++)
+	{
+		GekkoOPInfo *pInst = m_allInstructions[i];
+		pInst->fallbackCount = 0;
+		pInst->exceptionExitCount = 0;
+		pInst->dispatcherExitCount = 0;
+	}
+}
+
+std::vector<const GekkoOPInfo*> GetJitCounters()
+{
+	std::vector<const GekkoOPInfo*> counters;
+	for (int i = 0; i < m_numInstructions; i++)
+	{
+		if (JitCounterSum(m_allInstructions[i]) > 0)
+			counters.push_back(m_allInstructions[i]);
+	}
+	std::sort(counters.begin(), counters.end(),
+		[](const GekkoOPInfo* a, const GekkoOPInfo* b)
+		{
+			return JitCounterSum(a) > JitCounterSum(b);
+		});
+	return counters;
+}
+
+void LogJitCounters(const std::string& filename)
+{
+	File::IOFile f(filename, "w");
+	if (!f)
+	{
+		PanicAlert("Failed to open %s", filename.c_str());
+		return;
+	}
+
+	fprintf(f.GetHandle(), "opname\tfallbacks\texceptionExits\tdispatcherExits\tcompileCount\n");
+	for (const GekkoOPInfo* pInst : GetJitCounters())
+	{
+		fprintf(f.GetHandle(), "%s\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%i\n", pInst->opname,
+			pInst->fallbackCount, pInst->exceptionExitCount, pInst->dispatcherExitCount, pInst->compileCount);
+	}
+}
+
 }  // namespace
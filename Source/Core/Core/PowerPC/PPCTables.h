@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "Core/PowerPC/Gekko.h"
 #include "Core/PowerPC/Interpreter/Interpreter.h"
 
@@ -88,6 +91,11 @@ struct GekkoOPInfo
 	u64 runCount;
 	int compileCount;
 	u32 lastUse;
+
+	// Counted by Jit64 at runtime while blocks are profiled
+	u64 fallbackCount;       // executed through the interpreter
+	u64 exceptionExitCount;  // left the block to handle an exception
+	u64 dispatcherExitCount; // left the block for a target only known at runtime
 };
 extern GekkoOPInfo *m_infoTable[64];
 extern GekkoOPInfo *m_infoTable4[1024];
@@ -113,6 +121,10 @@ bool UsesFPU(UGeckoInstruction _inst);
 void CountInstruction(UGeckoInstruction _inst);
 void PrintInstructionRunCounts();
 void LogCompiledInstructions();
+void ResetJitCounters();
+// Instructions with nonzero JIT counters, most frequent first
+std::vector<const GekkoOPInfo*> GetJitCounters();
+void LogJitCounters(const std::string& filename);
 const char *GetInstructionName(UGeckoInstruction _inst);
 
 }  // namespace
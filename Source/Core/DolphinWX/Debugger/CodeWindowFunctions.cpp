@@ -29,6 +29,7 @@
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
+#include "Core/PowerPC/PPCTables.h"
 #include "Core/PowerPC/Profiler.h"
 #include "Core/PowerPC/SignatureDB.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
@@ -193,6 +194,7 @@ void CCodeWindow::OnProfilerMenu(wxCommandEvent& event)
 		Core::SetState(Core::CORE_PAUSE);
 		if (jit != nullptr)
 			jit->ClearCache();
+		PPCTables::ResetJitCounters();
 		Profiler::g_ProfileBlocks = GetMenuBar()->IsChecked(IDM_PROFILE_BLOCKS);
 		Core::SetState(Core::CORE_RUN);
 		break;
@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <cinttypes>
 #include <cstdio>
 #include <cstring>
 #include <disasm.h>        // Bochs
@@ -16,16 +17,19 @@
 #endif
 
 #include <wx/button.h>
+#include <wx/listbox.h>
 #include <wx/listctrl.h>
 #include <wx/panel.h>
 #include <wx/sizer.h>
 #include <wx/textctrl.h>
 
 #include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
 #include "Common/GekkoDisassembler.h"
 #include "Common/StringUtil.h"
 #include "Core/PowerPC/Gekko.h"
 #include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PPCTables.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
 #include "DolphinWX/Globals.h"
@@ -210,9 +214,16 @@ CJitWindow::CJitWindow(wxWindow* parent, wxWindowID id, const wxPoint& pos,
 				wxLC_REPORT | wxSUNKEN_BORDER | wxLC_ALIGN_LEFT | wxLC_SINGLE_SEL | wxLC_SORT_ASCENDING),
 				0, wxEXPAND);
 	sizerBig->Add(sizerSplit, 2, wxEXPAND);
-
-	sizerBig->Add(button_refresh = new wxButton(this, wxID_ANY, _("&Refresh")));
+	// Interpreter fallbacks and block exits per instruction, see Profiler > Profile blocks
+	sizerBig->Add(top_instructions = new wxListBox(this, wxID_ANY,
+				wxDefaultPosition, wxSize(100, 100)), 1, wxEXPAND);
+
+	wxBoxSizer* sizerButtons = new wxBoxSizer(wxHORIZONTAL);
+	sizerButtons->Add(button_refresh = new wxButton(this, wxID_ANY, _("&Refresh")));
+	sizerButtons->Add(button_dump_counters = new wxButton(this, wxID_ANY, _("&Dump counters")));
+	sizerBig->Add(sizerButtons);
 	button_refresh->Bind(wxEVT_BUTTON, &CJitWindow::OnRefresh, this);
+	button_dump_counters->Bind(wxEVT_BUTTON, &CJitWindow::OnDumpCounters, this);
 
 	SetSizer(sizerBig);
 
@@ -230,11 +241,41 @@ CJitWindow::CJitWindow(wxWindow* parent, wxWindowID id, const wxPoint& pos,
 #else
 	m_disassembler.reset(new HostDisassembler());
 #endif
+
+	m_counter_timer.SetOwner(this);
+	Bind(wxEVT_TIMER, &CJitWindow::OnCounterTimer, this);
+	m_counter_timer.Start(1000, wxTIMER_CONTINUOUS);
 }
 
 void CJitWindow::OnRefresh(wxCommandEvent& /*event*/)
 {
 	block_list->Update();
+	UpdateCounters();
+}
+
+void CJitWindow::OnDumpCounters(wxCommandEvent& /*event*/)
+{
+	std::string filename = File::GetUserPath(D_DUMP_IDX) + "Debug/jit_counters.txt";
+	File::CreateFullPath(filename);
+	PPCTables::LogJitCounters(filename);
+}
+
+void CJitWindow::OnCounterTimer(wxTimerEvent& /*event*/)
+{
+	if (IsShownOnScreen())
+		UpdateCounters();
+}
+
+void CJitWindow::UpdateCounters()
+{
+	// The counters are only updated by code compiled while profiling blocks
+	wxArrayString lines;
+	for (const GekkoOPInfo* info : PPCTables::GetJitCounters())
+	{
+		lines.Add(StrToWxStr(StringFromFormat("%-10s fallbacks: %" PRIu64 "  exception exits: %" PRIu64 "  dispatcher exits: %" PRIu64,
+			info->opname, info->fallbackCount, info->exceptionExitCount, info->dispatcherExitCount)));
+	}
+	top_instructions->Set(lines);
 }
 
 void CJitWindow::ViewAddr(u32 em_address)
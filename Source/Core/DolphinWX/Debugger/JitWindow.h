@@ -10,6 +10,7 @@
 
 #include <wx/listctrl.h>
 #include <wx/panel.h>
+#include <wx/timer.h>
 
 #include "Common/CommonTypes.h"
 
@@ -61,14 +62,19 @@ public:
 
 private:
 	void OnRefresh(wxCommandEvent& /*event*/);
+	void OnDumpCounters(wxCommandEvent& /*event*/);
+	void OnCounterTimer(wxTimerEvent& /*event*/);
+	void UpdateCounters();
 	void Compare(u32 em_address);
 
 	JitBlockList* block_list;
 	std::unique_ptr<HostDisassembler> m_disassembler;
 	wxButton* button_refresh;
+	wxButton* button_dump_counters;
 	wxTextCtrl* ppc_box;
 	wxTextCtrl* x86_box;
 	wxListBox* top_instructions;
+	wxTimer m_counter_timer;
 
 	void OnSymbolListChange(wxCommandEvent& event);
 	void OnCallstackListChange(wxCommandEvent& event);
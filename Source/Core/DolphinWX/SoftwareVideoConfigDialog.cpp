@@ -81,6 +81,18 @@ SoftwareVideoConfigDialog::SoftwareVideoConfigDialog(wxWindow* parent, const std
 
 	// xfb
 	szr_rendering->Add(new SettingCheckBox(page_general, _("Bypass XFB"), "", vconfig.bBypassXFB));
+
+	// threads
+	wxStaticText* const label_threads = new wxStaticText(page_general, wxID_ANY, _("Rasterizer threads (0 = auto):"));
+	U32Setting* const spin_threads = new U32Setting(page_general, _("Rasterizer threads"), vconfig.rasterizerThreads, 0, 16);
+	szr_rendering->Add(label_threads, 1, wxALIGN_CENTER_VERTICAL, 5);
+	szr_rendering->Add(spin_threads, 1, 0, 0);
+
+	if (Core::GetState() != Core::CORE_UNINITIALIZED)
+	{
+		label_threads->Disable();
+		spin_threads->Disable();
+	}
 	}
 
 	// - info
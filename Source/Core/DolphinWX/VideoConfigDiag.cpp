@@ -127,9 +127,19 @@ static wxString aa_desc = _("Reduces the amount of aliasing caused by rasterizin
 static wxString scaled_efb_copy_desc = _("Greatly increases quality of textures generated using render-to-texture effects.\nRaising the internal resolution will improve the effect of this setting.\nSlightly increases GPU load and causes relatively few graphical issues.\n\nIf unsure, leave this checked.");
 static wxString pixel_lighting_desc = _("Calculates lighting of 3D objects per-pixel rather than per-vertex, smoothing out the appearance of lit polygons and making individual triangles less noticeable.\nRarely causes slowdowns or graphical issues.\n\nIf unsure, leave this unchecked.");
 static wxString fast_depth_calc_desc = _("Use a less accurate algorithm to calculate depth values.\nCauses issues in a few games, but can give a decent speedup depending on the game and/or your GPU.\n\nIf unsure, leave this checked.");
+static wxString background_shader_compiling_desc = _("Compile new shaders on a separate thread instead of stalling emulation while they are built.\nObjects using a shader which isn't ready yet are not drawn until it is, which may cause brief graphical glitches.\nOnly supported by the OpenGL backend on some platforms.\n\nIf unsure, leave this unchecked.");
+static wxString reuse_vertex_uploads_desc = _("Checks whether the vertex and index data of each draw call was already uploaded to the GPU and draws from the existing copy if so.\nSaves bandwidth when the same geometry is sent several times, e.g. with opcode replay, at the cost of hashing every draw call.\nOnly supported by the OpenGL backend.\n\nIf unsure, leave this unchecked.");
+static wxString watch_texture_memory_desc = _("Write-protects the memory of loaded textures and only rehashes a texture when the game has written to it since.\nSaves CPU time in games with many or large textures, but writes to watched memory become slower.\nOnly works for GameCube games with fastmem enabled.\n\nIf unsure, leave this unchecked.");
+static wxString cache_display_list_vertices_desc = _("Keeps the converted vertices of geometry drawn from display lists and reuses them while the game doesn't modify the list or its vertex data.\nSaves CPU time in games which draw static geometry from the same display lists every frame. Works best together with \"Reuse Uploaded Vertices\".\nOnly works for GameCube games with fastmem enabled.\n\nIf unsure, leave this unchecked.");
+static wxString compile_display_lists_desc = _("Remembers the commands of display lists which the game calls repeatedly and executes them without decoding the list again, while the game doesn't modify the list.\nSaves CPU time in games which do most of their drawing with display lists.\nOnly works for GameCube games with fastmem enabled.\n\nIf unsure, leave this unchecked.");
+static wxString multithreaded_texture_decoding_desc = _("Decodes large textures on several CPU threads.\nReduces stuttering when games load big textures, e.g. at level transitions.\nThe minimum texture size can be changed with TextureDecodingThreshold in the ini file.\n\nIf unsure, leave this unchecked.");
+static wxString gpu_texture_decoding_desc = _("Decodes textures with shaders on the GPU instead of on the CPU.\nSpeeds up games which load many textures, but may be slower on weak GPUs.\nCustom textures are always decoded on the CPU.\n\nIf unsure, leave this unchecked.");
+static wxString defer_efb_copies_desc = _("Leaves the results of EFB copies to RAM on the GPU until the game can notice them, instead of waiting for the GPU after every copy.\nSpeeds up games which do many EFB copies to RAM. Games which read the copies without synchronizing with the GPU first may show glitches.\nOnly supported by the OpenGL backend.\n\nIf unsure, leave this unchecked.");
 static wxString force_filtering_desc = _("Filter all textures, including any that the game explicitly set as unfiltered.\nMay improve quality of certain textures in some games, but will cause issues in others.\nOn Direct3D, setting Anisotropic Filtering above 1x will also have the same effect as enabling this option.\n\nIf unsure, leave this unchecked.");
 static wxString borderless_fullscreen_desc = _("Implement fullscreen mode with a borderless window spanning the whole screen instead of using exclusive mode.\nAllows for faster transitions between fullscreen and windowed mode, but slightly increases input latency, makes movement less smooth and slightly decreases performance.\nExclusive mode is required for Nvidia 3D Vision to work in the Direct3D backend.\n\nIf unsure, leave this unchecked.");
 static wxString internal_res_desc = _("Specifies the resolution used to render at. A high resolution greatly improves visual quality, but also greatly increases GPU load and can cause issues in certain games.\n\"Multiple of 640x528\" will result in a size slightly larger than \"Window Size\" but yield fewer issues. Generally speaking, the lower the internal resolution is, the better your performance will be.\n\nIf unsure, select 640x528.");
+static wxString bbox_mode_desc = _("How the bounding box of rendered pixels is computed when the game reads it, e.g. Paper Mario games.\n\nAccurate waits for the GPU on every read.\nAsynchronous uses results which are read back from the GPU in the background and may be from an earlier frame. Only supported by the OpenGL backend, other backends wait for the GPU.\nEstimate computes a box around the drawn geometry on the CPU, which is fast but may be too large.\n\nIf unsure, select Accurate.");
+static wxString async_efb_peeks_desc = _("Answers CPU reads from the EFB with a copy of the whole EFB which is read back in the background, instead of waiting for the GPU on every read.\nSpeeds up games which read the EFB every frame, e.g. for lens flares. The values may be slightly outdated; how many frames old they may be can be changed with EFBPeekLatency in the ini file.\nOnly supported by the OpenGL backend.\n\nIf unsure, leave this unchecked.");
 static wxString efb_access_desc = _("Ignore any requests from the CPU to read from or write to the EFB.\nImproves performance in some games, but might disable some gameplay-related features or graphical effects.\n\nIf unsure, leave this unchecked.");
 static wxString efb_emulate_format_changes_desc = _("Ignore any changes to the EFB format.\nImproves performance in many games without any negative effect. Causes graphical defects in a small number of other games.\n\nIf unsure, leave this checked.");
 static wxString efb_copy_desc = _("Disable emulation of EFB copies.\nThese are often used for post-processing or render-to-texture effects, so while checking this setting may give a minor speedup over EFB to Texture it almost invariably also causes issues.\n\nIf unsure, leave this unchecked.");
@@ -517,7 +527,19 @@ VideoConfigDiag::VideoConfigDiag(wxWindow* parent, const std::string &title, con
 
 	szr_efb->Add(CreateCheckBox(page_hacks, _("Skip EFB Access from CPU"), efb_access_desc, vconfig.bEFBAccessEnable, true), 0, wxBOTTOM | wxLEFT, 5);
 	szr_efb->Add(CreateCheckBox(page_hacks, _("Ignore Format Changes"), efb_emulate_format_changes_desc, vconfig.bEFBEmulateFormatChanges, true), 0, wxBOTTOM | wxLEFT, 5);
+	szr_efb->Add(CreateCheckBox(page_hacks, _("Asynchronous EFB Access"), async_efb_peeks_desc, vconfig.bAsyncEFBPeeks), 0, wxBOTTOM | wxLEFT, 5);
 	szr_efb->Add(group_efbcopy, 0, wxEXPAND | wxALL, 5);
+	if (vconfig.backend_info.bSupportsBBox)
+	{
+		const wxString bbox_choices[] = { _("Accurate"), _("Asynchronous"), _("Estimate") };
+
+		wxBoxSizer* const szr_bbox = new wxBoxSizer(wxHORIZONTAL);
+		szr_bbox->Add(new wxStaticText(page_hacks, wxID_ANY, _("Bounding Box:")), 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
+		szr_bbox->Add(CreateChoice(page_hacks, vconfig.iBBoxMode, bbox_mode_desc,
+		                           sizeof(bbox_choices) / sizeof(*bbox_choices), bbox_choices));
+		szr_efb->Add(szr_bbox, 0, wxBOTTOM | wxLEFT, 5);
+	}
+	szr_efb->Add(CreateCheckBox(page_hacks, _("Defer EFB Copies to RAM"), defer_efb_copies_desc, vconfig.bDeferEFBCopies), 0, wxBOTTOM | wxLEFT, 5);
 	// szr_efb->Add(CreateCheckBox(page_hacks, _("Store EFB Copies to Texture Only"), skip_efb_copy_to_ram_desc, vconfig.bSkipEFBCopyToRam), 0, wxBOTTOM | wxLEFT, 5);
 
 	szr_hacks->Add(szr_efb, 0, wxEXPAND | wxALL, 5);
@@ -564,6 +586,14 @@ VideoConfigDiag::VideoConfigDiag(wxWindow* parent, const std::string &title, con
 	wxGridSizer* const szr_other = new wxGridSizer(2, 5, 5);
 	szr_other->Add(CreateCheckBox(page_hacks, _("Disable Destination Alpha"), disable_dstalpha_desc, vconfig.bDstAlphaPass));
 	szr_other->Add(CreateCheckBox(page_hacks, _("Fast Depth Calculation"), fast_depth_calc_desc, vconfig.bFastDepthCalc));
+	szr_other->Add(CreateCheckBox(page_hacks, _("Background Shader Compilation"), background_shader_compiling_desc, vconfig.bBackgroundShaderCompiling));
+	szr_other->Add(CreateCheckBox(page_hacks, _("Reuse Uploaded Vertices"), reuse_vertex_uploads_desc, vconfig.bReuseVertexUploads));
+	szr_other->Add(CreateCheckBox(page_hacks, _("Skip Rehashing Unmodified Textures"), watch_texture_memory_desc, vconfig.bWatchTextureMemory));
+	szr_other->Add(CreateCheckBox(page_hacks, _("Cache Display List Vertices"), cache_display_list_vertices_desc, vconfig.bCacheDisplayListVertices));
+	szr_other->Add(CreateCheckBox(page_hacks, _("Compile Display Lists"), compile_display_lists_desc, vconfig.bCompileDisplayLists));
+	szr_other->Add(CreateCheckBox(page_hacks, _("Multi-threaded Texture Decoding"), multithreaded_texture_decoding_desc, vconfig.bMultithreadedTextureDecoding));
+	if (vconfig.backend_info.bSupportsGPUTextureDecoding)
+		szr_other->Add(CreateCheckBox(page_hacks, _("GPU Texture Decoding"), gpu_texture_decoding_desc, vconfig.bGPUTextureDecoding));
 
 	wxStaticBoxSizer* const group_other = new wxStaticBoxSizer(wxVERTICAL, page_hacks, _("Other"));
 	group_other->Add(szr_other, 1, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 5);
@@ -84,6 +84,7 @@ void InitBackendInfo()
 	g_Config.backend_info.bSupports3DVision = true;
 	g_Config.backend_info.bSupportsPostProcessing = false;
 	g_Config.backend_info.bSupportsPaletteConversion = true;
+	g_Config.backend_info.bSupportsGPUTextureDecoding = false;
 
 	IDXGIFactory* factory;
 	IDXGIAdapter* ad;
@@ -2,13 +2,80 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cstring>
+
 #include "VideoBackends/OGL/BoundingBox.h"
 #include "VideoBackends/OGL/GLUtil.h"
+#include "VideoBackends/OGL/Render.h"
 
 #include "VideoCommon/VideoConfig.h"
 
 static GLuint s_bbox_buffer_id;
 
+// Asynchronous reads: the buffer is copied to one of these when the game reads
+// the bounding box after it changed, and reads are answered from the newest
+// copy which has finished.
+static const int BBOX_READBACK_COUNT = 3;
+struct BBoxReadback
+{
+	GLuint buffer;
+	GLsync fence;
+};
+static BBoxReadback s_readbacks[BBOX_READBACK_COUNT];
+static int s_readback_next = 0; // also the oldest one in flight
+static int s_readback_values[4];
+static bool s_readback_values_valid = false;
+static bool s_readback_needed = true; // the buffer changed since the last readback was started
+
+static void FinishReadback(BBoxReadback& readback)
+{
+	glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+	glDeleteSync(readback.fence);
+	readback.fence = 0;
+
+	glBindBuffer(GL_COPY_READ_BUFFER, readback.buffer);
+	void* ptr = glMapBufferRange(GL_COPY_READ_BUFFER, 0, sizeof(s_readback_values), GL_MAP_READ_BIT);
+	if (ptr)
+	{
+		memcpy(s_readback_values, ptr, sizeof(s_readback_values));
+		glUnmapBuffer(GL_COPY_READ_BUFFER);
+		s_readback_values_valid = true;
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+// Takes the results of the readbacks which have finished, oldest first
+static void UpdateReadbackValues()
+{
+	for (int i = 0; i < BBOX_READBACK_COUNT; i++)
+	{
+		BBoxReadback& readback = s_readbacks[(s_readback_next + i) % BBOX_READBACK_COUNT];
+		if (!readback.fence)
+			continue;
+		if (glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED)
+			break;
+		FinishReadback(readback);
+	}
+}
+
+static void StartReadback()
+{
+	// All readbacks are in flight, wait for the oldest one
+	BBoxReadback& readback = s_readbacks[s_readback_next];
+	if (readback.fence)
+		FinishReadback(readback);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, s_bbox_buffer_id);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(s_readback_values));
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	s_readback_next = (s_readback_next + 1) % BBOX_READBACK_COUNT;
+	s_readback_needed = false;
+}
+
 namespace OGL
 {
 
@@ -21,13 +88,40 @@ void BoundingBox::Init()
 		glBindBuffer(GL_SHADER_STORAGE_BUFFER, s_bbox_buffer_id);
 		glBufferData(GL_SHADER_STORAGE_BUFFER, 4 * sizeof(s32), initial_values, GL_DYNAMIC_DRAW);
 		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, s_bbox_buffer_id);
+
+		if (g_ogl_config.bSupportsGLSync)
+		{
+			for (BBoxReadback& readback : s_readbacks)
+			{
+				glGenBuffers(1, &readback.buffer);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+				glBufferData(GL_COPY_WRITE_BUFFER, 4 * sizeof(s32), nullptr, GL_STREAM_READ);
+				readback.fence = 0;
+			}
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
 	}
 }
 
 void BoundingBox::Shutdown()
 {
-	if (g_ActiveConfig.backend_info.bSupportsBBox)
-		glDeleteBuffers(1, &s_bbox_buffer_id);
+	if (!g_ActiveConfig.backend_info.bSupportsBBox)
+		return;
+
+	glDeleteBuffers(1, &s_bbox_buffer_id);
+	if (g_ogl_config.bSupportsGLSync)
+	{
+		for (BBoxReadback& readback : s_readbacks)
+		{
+			if (readback.fence)
+				glDeleteSync(readback.fence);
+			readback.fence = 0;
+			glDeleteBuffers(1, &readback.buffer);
+		}
+	}
+	s_readback_next = 0;
+	s_readback_values_valid = false;
+	s_readback_needed = true;
 }
 
 void BoundingBox::Set(int index, int value)
@@ -35,6 +129,7 @@ void BoundingBox::Set(int index, int value)
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, s_bbox_buffer_id);
 	glBufferSubData(GL_SHADER_STORAGE_BUFFER, index * sizeof(int), sizeof(int), &value);
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	s_readback_needed = true;
 }
 
 int BoundingBox::Get(int index)
@@ -51,4 +146,23 @@ int BoundingBox::Get(int index)
 	return data;
 }
 
+bool BoundingBox::GetLatest(int index, int* value)
+{
+	// Games read all four values in a row, only the first one starts a readback.
+	if (s_readback_needed)
+		StartReadback();
+
+	UpdateReadbackValues();
+	if (!s_readback_values_valid)
+		return false;
+
+	*value = s_readback_values[index];
+	return true;
+}
+
+void BoundingBox::Invalidate()
+{
+	s_readback_needed = true;
+}
+
 };
@@ -15,6 +15,13 @@ public:
 
 	static void Set(int index, int value);
 	static int Get(int index);
+
+	// Answers from readbacks which were started on earlier reads instead of
+	// waiting for the GPU, for BBOX_ASYNC. Returns false if none has finished yet.
+	static bool GetLatest(int index, int* value);
+
+	// Called after drawing while the bounding box is active
+	static void Invalidate();
 };
 
 };
@@ -632,6 +632,7 @@ PFNGLDRAWARRAYSINSTANCEDPROC glDrawArraysInstanced;
 PFNGLDRAWELEMENTSINSTANCEDPROC glDrawElementsInstanced;
 PFNGLPRIMITIVERESTARTINDEXPROC glPrimitiveRestartIndex;
 PFNGLTEXBUFFERPROC glTexBuffer;
+PFNGLCOPYBUFFERSUBDATAPROC glCopyBufferSubData;
 
 // gl_3_2
 PFNGLFRAMEBUFFERTEXTUREPROC glFramebufferTexture;
@@ -1085,6 +1086,7 @@ const GLFunc gl_function_array[] =
 	GLFUNC_REQUIRES(glDrawElementsInstanced, "VERSION_3_1"),
 	GLFUNC_REQUIRES(glPrimitiveRestartIndex, "VERSION_3_1"),
 	GLFUNC_REQUIRES(glTexBuffer,             "VERSION_3_1"),
+	GLFUNC_REQUIRES(glCopyBufferSubData,     "VERSION_3_1"),
 
 	// gl_3_2
 	GLFUNC_REQUIRES(glFramebufferTexture,     "VERSION_3_2"),
@@ -8,4 +8,5 @@ extern PFNGLDRAWARRAYSINSTANCEDPROC glDrawArraysInstanced;
 extern PFNGLDRAWELEMENTSINSTANCEDPROC glDrawElementsInstanced;
 extern PFNGLPRIMITIVERESTARTINDEXPROC glPrimitiveRestartIndex;
 extern PFNGLTEXBUFFERPROC glTexBuffer;
+extern PFNGLCOPYBUFFERSUBDATAPROC glCopyBufferSubData;
 
@@ -284,3 +284,63 @@ void cInterfaceGLX::ShutdownOffscreen()
 	}
 }
 
+
+// Create a context in the same share group as the one current on the calling
+// thread. It is made current without a drawable, which GLX_ARB_create_context
+// allows for GL 3.0+ contexts, so it can only be used for object creation.
+bool cInterfaceGLX::CreateSharedContext()
+{
+	GLXContext share_ctx = glXGetCurrentContext();
+	if (!share_ctx || !glXCreateContextAttribs)
+		return false;
+
+	// fbconfig belongs to the display of the main context, so use that one.
+	dpy_shared = glXGetCurrentDisplay();
+	if (!dpy_shared)
+		return false;
+
+	int context_attribs[] =
+	{
+		GLX_CONTEXT_MAJOR_VERSION_ARB, 3,
+		GLX_CONTEXT_MINOR_VERSION_ARB, 3,
+		GLX_CONTEXT_PROFILE_MASK_ARB,  GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+		GLX_CONTEXT_FLAGS_ARB,         GLX_CONTEXT_FORWARD_COMPATIBLE_BIT_ARB,
+		None
+	};
+	s_glxError = false;
+	XErrorHandler oldHandler = XSetErrorHandler(&ctxErrorHandler);
+	ctx_shared = glXCreateContextAttribs(dpy_shared, fbconfig, share_ctx, True, context_attribs);
+	XSync(dpy_shared, False);
+	XSetErrorHandler(oldHandler);
+	if (!ctx_shared || s_glxError)
+	{
+		INFO_LOG(VIDEO, "Unable to create shared GL context.");
+		ShutdownSharedContext();
+		return false;
+	}
+	return true;
+}
+
+bool cInterfaceGLX::MakeCurrentShared()
+{
+	if (!ctx_shared)
+		return false;
+	return glXMakeContextCurrent(dpy_shared, None, None, ctx_shared) ? true : false;
+}
+
+bool cInterfaceGLX::ClearCurrentShared()
+{
+	if (!dpy_shared)
+		return false;
+	return glXMakeContextCurrent(dpy_shared, None, None, nullptr) ? true : false;
+}
+
+void cInterfaceGLX::ShutdownSharedContext()
+{
+	if (ctx_shared)
+	{
+		glXDestroyContext(dpy_shared, ctx_shared);
+		ctx_shared = nullptr;
+	}
+	dpy_shared = nullptr;
+}
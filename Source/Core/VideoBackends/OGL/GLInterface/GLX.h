@@ -17,6 +17,8 @@ private:
 	Display *dpy, *dpy_offscreen;
 	Window win;//, win_offscreen;
 	GLXContext ctx, ctx_offscreen;
+	Display *dpy_shared = nullptr;
+	GLXContext ctx_shared = nullptr;
 	GLXFBConfig fbconfig;
 public:
 	const Display* getDisplay() {return dpy;};
@@ -33,4 +35,9 @@ public:
 
 	void Shutdown() override;
 	void ShutdownOffscreen();
+
+	bool CreateSharedContext() override;
+	bool MakeCurrentShared() override;
+	bool ClearCurrentShared() override;
+	void ShutdownSharedContext() override;
 };
@@ -38,6 +38,15 @@ public:
 	virtual void Shutdown() {}
 	virtual void ShutdownOffscreen() {}
 
+	// Secondary context sharing objects with the one current on the calling
+	// thread, used by worker threads (e.g. background shader compilation).
+	// Interfaces which don't implement it return false and callers fall back
+	// to doing the work on the video thread.
+	virtual bool CreateSharedContext() { return false; }
+	virtual bool MakeCurrentShared() { return false; }
+	virtual bool ClearCurrentShared() { return false; }
+	virtual void ShutdownSharedContext() {}
+
 	virtual void SwapInterval(int Interval) { }
 	virtual u32 GetBackBufferWidth() { return s_backbuffer_width; }
 	virtual u32 GetBackBufferHeight() { return s_backbuffer_height; }
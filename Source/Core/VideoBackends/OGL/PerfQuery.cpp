@@ -6,6 +6,8 @@
 #include "VideoBackends/OGL/GLUtil.h"
 #include "VideoBackends/OGL/PerfQuery.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VideoConfig.h"
 
 namespace OGL
 {
@@ -21,8 +23,9 @@ PerfQueryBase* GetPerfQuery()
 }
 
 PerfQuery::PerfQuery()
-	: m_query_read_pos()
+	: m_query_read_pos(), m_pending_measurement_queries(0)
 {
+	std::fill_n(m_last_results, ArraySize(m_last_results), 0);
 	ResetQuery();
 }
 
@@ -49,7 +52,28 @@ void PerfQuery::FlushResults()
 
 void PerfQuery::ResetQuery()
 {
+	if (g_ActiveConfig.iPerfQueryLatency > 0)
+	{
+		// Keep the pending queries, their results become the last known values once they arrive
+		if (m_query_count == 0)
+		{
+			std::copy(m_results, m_results + PQG_NUM_MEMBERS, m_last_results);
+		}
+		else
+		{
+			PendingMeasurement measurement;
+			measurement.query_count = m_query_count - m_pending_measurement_queries;
+			std::copy(m_results, m_results + PQG_NUM_MEMBERS, measurement.results);
+			m_pending_measurements.push_back(measurement);
+			m_pending_measurement_queries = m_query_count;
+		}
+		std::fill_n(m_results, ArraySize(m_results), 0);
+		return;
+	}
+
 	m_query_count = 0;
+	m_pending_measurements.clear();
+	m_pending_measurement_queries = 0;
 	std::fill_n(m_results, ArraySize(m_results), 0);
 }
 
@@ -57,26 +81,65 @@ u32 PerfQuery::GetQueryResult(PerfQueryType type)
 {
 	u32 result = 0;
 
+	// The guest is reading before the GPU is done, answer with the last complete measurement
+	const volatile u32* results = m_results;
+	if (g_ActiveConfig.iPerfQueryLatency > 0 && !IsFlushed())
+		results = m_last_results;
+
 	if (type == PQ_ZCOMP_INPUT_ZCOMPLOC || type == PQ_ZCOMP_OUTPUT_ZCOMPLOC)
 	{
-		result = m_results[PQG_ZCOMP_ZCOMPLOC];
+		result = results[PQG_ZCOMP_ZCOMPLOC];
 	}
 	else if (type == PQ_ZCOMP_INPUT || type == PQ_ZCOMP_OUTPUT)
 	{
-		result = m_results[PQG_ZCOMP];
+		result = results[PQG_ZCOMP];
 	}
 	else if (type == PQ_BLEND_INPUT)
 	{
-		result = m_results[PQG_ZCOMP] + m_results[PQG_ZCOMP_ZCOMPLOC];
+		result = results[PQG_ZCOMP] + results[PQG_ZCOMP_ZCOMPLOC];
 	}
 	else if (type == PQ_EFB_COPY_CLOCKS)
 	{
-		result = m_results[PQG_EFB_COPY_CLOCKS];
+		result = results[PQG_EFB_COPY_CLOCKS];
 	}
 
 	return result / 4;
 }
 
+void PerfQuery::AddResult(GLuint result)
+{
+	auto& entry = m_query_buffer[m_query_read_pos];
+
+	// NOTE: Reported pixel metrics should be referenced to native resolution
+	u32 value = (u32)((u64)result * EFB_WIDTH / g_renderer->GetTargetWidth() * EFB_HEIGHT / g_renderer->GetTargetHeight());
+
+	if (m_pending_measurements.empty())
+	{
+		m_results[entry.query_type] += value;
+	}
+	else
+	{
+		m_pending_measurements.front().results[entry.query_type] += value;
+		m_pending_measurements.front().query_count--;
+		m_pending_measurement_queries--;
+
+		while (!m_pending_measurements.empty() && m_pending_measurements.front().query_count == 0)
+		{
+			const u32* results = m_pending_measurements.front().results;
+			std::copy(results, results + PQG_NUM_MEMBERS, m_last_results);
+			m_pending_measurements.pop_front();
+		}
+	}
+
+	m_query_read_pos = (m_query_read_pos + 1) % m_query_buffer.size();
+	--m_query_count;
+}
+
+bool PerfQuery::IsOverdue(const ActiveQuery& query) const
+{
+	return g_ActiveConfig.iPerfQueryLatency > 0 && frameCount - query.frame >= g_ActiveConfig.iPerfQueryLatency;
+}
+
 // Implementations
 PerfQueryGL::PerfQueryGL(GLenum query_type)
 	: m_query_type(query_type)
@@ -94,12 +157,13 @@ PerfQueryGL::~PerfQueryGL()
 void PerfQueryGL::EnableQuery(PerfQueryGroup type)
 {
 	// Is this sane?
-	if (m_query_count > m_query_buffer.size() / 2)
+	if (m_query_count > m_query_buffer.size() / 2 || g_ActiveConfig.iPerfQueryLatency > 0)
 		WeakFlush();
 
 	if (m_query_buffer.size() == m_query_count)
 	{
 		FlushOne();
+		stats.thisFrame.numPerfQueryWaits++;
 		//ERROR_LOG(VIDEO, "Flushed query buffer early!");
 	}
 
@@ -110,6 +174,7 @@ void PerfQueryGL::EnableQuery(PerfQueryGroup type)
 
 		glBeginQuery(m_query_type, entry.query_id);
 		entry.query_type = type;
+		entry.frame = frameCount;
 
 		++m_query_count;
 	}
@@ -136,6 +201,11 @@ void PerfQueryGL::WeakFlush()
 		{
 			FlushOne();
 		}
+		else if (IsOverdue(entry))
+		{
+			FlushOne();
+			stats.thisFrame.numPerfQueryWaits++;
+		}
 		else
 		{
 			break;
@@ -150,16 +220,15 @@ void PerfQueryGL::FlushOne()
 	GLuint result = 0;
 	glGetQueryObjectuiv(entry.query_id, GL_QUERY_RESULT, &result);
 
-	// NOTE: Reported pixel metrics should be referenced to native resolution
-	m_results[entry.query_type] += (u64)result * EFB_WIDTH / g_renderer->GetTargetWidth() * EFB_HEIGHT / g_renderer->GetTargetHeight();
-
-	m_query_read_pos = (m_query_read_pos + 1) % m_query_buffer.size();
-	--m_query_count;
+	AddResult(result);
 }
 
 // TODO: could selectively flush things, but I don't think that will do much
 void PerfQueryGL::FlushResults()
 {
+	if (!IsFlushed())
+		stats.thisFrame.numPerfQueryWaits++;
+
 	while (!IsFlushed())
 		FlushOne();
 }
@@ -179,12 +248,13 @@ PerfQueryGLESNV::~PerfQueryGLESNV()
 void PerfQueryGLESNV::EnableQuery(PerfQueryGroup type)
 {
 	// Is this sane?
-	if (m_query_count > m_query_buffer.size() / 2)
+	if (m_query_count > m_query_buffer.size() / 2 || g_ActiveConfig.iPerfQueryLatency > 0)
 		WeakFlush();
 
 	if (m_query_buffer.size() == m_query_count)
 	{
 		FlushOne();
+		stats.thisFrame.numPerfQueryWaits++;
 		//ERROR_LOG(VIDEO, "Flushed query buffer early!");
 	}
 
@@ -195,6 +265,7 @@ void PerfQueryGLESNV::EnableQuery(PerfQueryGroup type)
 
 		glBeginOcclusionQueryNV(entry.query_id);
 		entry.query_type = type;
+		entry.frame = frameCount;
 
 		++m_query_count;
 	}
@@ -221,6 +292,11 @@ void PerfQueryGLESNV::WeakFlush()
 		{
 			FlushOne();
 		}
+		else if (IsOverdue(entry))
+		{
+			FlushOne();
+			stats.thisFrame.numPerfQueryWaits++;
+		}
 		else
 		{
 			break;
@@ -235,16 +311,15 @@ void PerfQueryGLESNV::FlushOne()
 	GLuint result = 0;
 	glGetOcclusionQueryuivNV(entry.query_id, GL_OCCLUSION_TEST_RESULT_HP, &result);
 
-	// NOTE: Reported pixel metrics should be referenced to native resolution
-	m_results[entry.query_type] += (u64)result * EFB_WIDTH / g_renderer->GetTargetWidth() * EFB_HEIGHT / g_renderer->GetTargetHeight();
-
-	m_query_read_pos = (m_query_read_pos + 1) % m_query_buffer.size();
-	--m_query_count;
+	AddResult(result);
 }
 
 // TODO: could selectively flush things, but I don't think that will do much
 void PerfQueryGLESNV::FlushResults()
 {
+	if (!IsFlushed())
+		stats.thisFrame.numPerfQueryWaits++;
+
 	while (!IsFlushed())
 		FlushOne();
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <deque>
 #include <memory>
 
 #include "VideoBackends/OGL/GLExtensions/GLExtensions.h"
@@ -28,15 +29,35 @@ protected:
 	{
 		GLuint query_id;
 		PerfQueryGroup query_type;
+		int frame;
+	};
+
+	// A measurement which was ended by ResetQuery while some of its queries
+	// were still pending. Only used with PerfQueryLatency.
+	struct PendingMeasurement
+	{
+		u32 query_count;
+		u32 results[PQG_NUM_MEMBERS];
 	};
 
 	// when testing in SMS: 64 was too small, 128 was ok
-	static const u32 PERF_QUERY_BUFFER_SIZE = 512;
+	// PerfQueryLatency keeps the queries of several frames in flight.
+	static const u32 PERF_QUERY_BUFFER_SIZE = 2048;
+
+	// Adds the result of the oldest query to its measurement and removes it
+	void AddResult(GLuint result);
+	// With PerfQueryLatency, queries older than that many frames are waited for
+	bool IsOverdue(const ActiveQuery& query) const;
 
 	// This contains gl query objects with unretrieved results.
 	std::array<ActiveQuery, PERF_QUERY_BUFFER_SIZE> m_query_buffer;
 	u32 m_query_read_pos;
 
+	std::deque<PendingMeasurement> m_pending_measurements;
+	u32 m_pending_measurement_queries;
+	// Results of the newest complete measurement
+	volatile u32 m_last_results[PQG_NUM_MEMBERS];
+
 private:
 	// Implementation
 	std::unique_ptr<PerfQuery> m_query;
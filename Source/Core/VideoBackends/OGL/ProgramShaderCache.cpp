@@ -2,11 +2,22 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "Common/Event.h"
+#include "Common/Flag.h"
 #include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Core/Host.h"
 
+#include "VideoBackends/OGL/GLInterfaceBase.h"
 #include "VideoBackends/OGL/ProgramShaderCache.h"
 #include "VideoBackends/OGL/Render.h"
 #include "VideoBackends/OGL/StreamBuffer.h"
@@ -15,6 +26,7 @@
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -28,9 +40,12 @@ u32 ProgramShaderCache::s_ubo_buffer_size;
 s32 ProgramShaderCache::s_ubo_align;
 
 static StreamBuffer *s_buffer;
-static int num_failures = 0;
+static std::atomic<int> num_failures(0); // also counted by the compile thread
 
 static LinearDiskCache<SHADERUID, u8> g_program_disk_cache;
+// Unlike the binary cache, the sources stay valid across driver updates.
+static LinearDiskCache<SHADERUID, u8> g_program_source_cache;
+static bool s_source_cache_open = false;
 static GLuint CurrentProgram = 0;
 ProgramShaderCache::PCache ProgramShaderCache::pshaders;
 ProgramShaderCache::PCacheEntry* ProgramShaderCache::last_entry;
@@ -41,6 +56,47 @@ UidChecker<GeometryShaderUid,ShaderCode> ProgramShaderCache::geometry_uid_checke
 
 static char s_glsl_header[1024] = "";
 
+// Background shader compilation.
+// Shader code is generated on the video thread (it depends on the current
+// xf/bp state), then compiled and linked on a worker thread owning a context
+// that shares objects with the video thread's one. Until a program is ready,
+// draws using it are skipped.
+struct BackgroundCompileRequest
+{
+	SHADERUID uid;
+	SHADER shader;
+	std::string vcode, pcode, gcode;
+	bool has_gcode;
+	bool success;
+};
+
+static std::thread s_compile_thread;
+// Set by the compile thread itself, s_compile_thread may not be assigned yet when it starts working
+static std::atomic<std::thread::id> s_compile_thread_id;
+static Common::Flag s_compile_thread_running;
+static Common::Event s_compile_work_event;
+static std::mutex s_compile_lock;
+static std::deque<BackgroundCompileRequest> s_compile_queue;
+static std::vector<BackgroundCompileRequest> s_compile_results;
+// Alerts for failed background compiles, shown by the video thread
+static std::vector<std::string> s_compile_errors;
+static u32 s_num_pending_compiles = 0; // only touched by the video thread
+
+// PanicAlert blocks and may need the UI, so the compile thread leaves it to
+// the video thread.
+static void ReportShaderError(const std::string& message)
+{
+	if (std::this_thread::get_id() == s_compile_thread_id.load())
+	{
+		std::lock_guard<std::mutex> lk(s_compile_lock);
+		s_compile_errors.push_back(message);
+	}
+	else
+	{
+		PanicAlert("%s", message.c_str());
+	}
+}
+
 static std::string GetGLSLVersionString()
 {
 	GLSL_VERSION v = g_ogl_config.eSupportedGLSLVersion;
@@ -82,7 +138,7 @@ void SHADER::SetProgramVariables()
 			glUniformBlockBinding(glprogid, GSBlock_id, 3);
 
 		// Bind Texture Sampler
-		for (int a = 0; a <= 9; ++a)
+		for (int a = 0; a <= 10; ++a)
 		{
 			char name[8];
 			snprintf(name, 8, "samp%d", a);
@@ -176,11 +232,17 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 	SHADERUID uid;
 	GetShaderId(&uid, dstAlphaMode, components, primitive_type);
 
+	if (s_num_pending_compiles)
+		RetrieveBackgroundCompiles();
+
 	// Check if the shader is already set
 	if (last_entry)
 	{
 		if (uid == last_uid)
 		{
+			if (last_entry->pending)
+				return nullptr;
+
 			GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
 			last_entry->shader.Bind();
 			return &last_entry->shader;
@@ -196,6 +258,9 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 		PCacheEntry *entry = &iter->second;
 		last_entry = entry;
 
+		if (last_entry->pending)
+			return nullptr;
+
 		GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
 		last_entry->shader.Bind();
 		return &last_entry->shader;
@@ -205,6 +270,7 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 	PCacheEntry& newentry = pshaders[uid];
 	last_entry = &newentry;
 	newentry.in_cache = 0;
+	newentry.pending = false;
 
 	VertexShaderCode vcode;
 	PixelShaderCode pcode;
@@ -239,6 +305,15 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 	}
 #endif
 
+	RecordShaderSource(uid, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer());
+
+	if (s_compile_thread_running.IsSet())
+	{
+		newentry.pending = true;
+		QueueBackgroundCompile(uid, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer());
+		return nullptr;
+	}
+
 	if (!CompileShader(newentry.shader, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer()))
 	{
 		GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
@@ -254,6 +329,18 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 }
 
 bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const char* pcode, const char* gcode)
+{
+	if (!CompileAndLinkProgram(shader, vcode, pcode, gcode))
+		return false;
+
+	shader.SetProgramVariables();
+
+	return true;
+}
+
+// Doesn't touch any state of the current context besides creating objects,
+// so this is safe to call from the background compile thread.
+bool ProgramShaderCache::CompileAndLinkProgram(SHADER& shader, const char* vcode, const char* pcode, const char* gcode)
 {
 	GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode);
 	GLuint psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode);
@@ -312,12 +399,12 @@ bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const
 
 		if (linkStatus != GL_TRUE)
 		{
-			PanicAlert("Failed to link shaders!\nThis usually happens when trying to use Dolphin with an outdated GPU or integrated GPU like the Intel GMA series.\n\nIf you're sure this is Dolphin's error anyway, post the contents of %s along with this error message at the forums.\n\nDebug info (%s, %s, %s):\n%s",
+			ReportShaderError(StringFromFormat("Failed to link shaders!\nThis usually happens when trying to use Dolphin with an outdated GPU or integrated GPU like the Intel GMA series.\n\nIf you're sure this is Dolphin's error anyway, post the contents of %s along with this error message at the forums.\n\nDebug info (%s, %s, %s):\n%s",
 				filename.c_str(),
 				g_ogl_config.gl_vendor,
 				g_ogl_config.gl_renderer,
 				g_ogl_config.gl_version,
-				infoLog);
+				infoLog));
 		}
 
 		delete [] infoLog;
@@ -329,11 +416,10 @@ bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const
 
 		// Don't try to use this shader
 		glDeleteProgram(pid);
+		shader.glprogid = 0;
 		return false;
 	}
 
-	shader.SetProgramVariables();
-
 	return true;
 }
 
@@ -371,13 +457,13 @@ GLuint ProgramShaderCache::CompileSingleShader(GLuint type, const char* code)
 
 		if (compileStatus != GL_TRUE)
 		{
-			PanicAlert("Failed to compile %s shader!\nThis usually happens when trying to use Dolphin with an outdated GPU or integrated GPU like the Intel GMA series.\n\nIf you're sure this is Dolphin's error anyway, post the contents of %s along with this error message at the forums.\n\nDebug info (%s, %s, %s):\n%s",
+			ReportShaderError(StringFromFormat("Failed to compile %s shader!\nThis usually happens when trying to use Dolphin with an outdated GPU or integrated GPU like the Intel GMA series.\n\nIf you're sure this is Dolphin's error anyway, post the contents of %s along with this error message at the forums.\n\nDebug info (%s, %s, %s):\n%s",
 				type == GL_VERTEX_SHADER ? "vertex" : type==GL_FRAGMENT_SHADER ? "pixel" : "geometry",
 				filename.c_str(),
 				g_ogl_config.gl_vendor,
 				g_ogl_config.gl_renderer,
 				g_ogl_config.gl_version,
-				infoLog);
+				infoLog));
 		}
 
 		delete[] infoLog;
@@ -417,6 +503,231 @@ void ProgramShaderCache::GetShaderId(SHADERUID* uid, DSTALPHA_MODE dstAlphaMode,
 	}
 }
 
+void ProgramShaderCache::StartCompileThread()
+{
+	if (!GLInterface->CreateSharedContext())
+	{
+		WARN_LOG(VIDEO, "No shared GL context available, compiling shaders on the video thread.");
+		return;
+	}
+
+	s_compile_thread_running.Set();
+	s_compile_thread = std::thread(CompileThreadFunc);
+}
+
+void ProgramShaderCache::StopCompileThread()
+{
+	if (!s_compile_thread_running.TestAndClear())
+		return;
+
+	s_compile_work_event.Set();
+	s_compile_thread.join();
+	s_compile_thread_id = std::thread::id();
+	GLInterface->ShutdownSharedContext();
+
+	// Whatever finished is kept, the rest is dropped with the cache.
+	s_compile_queue.clear();
+	RetrieveBackgroundCompiles();
+	s_num_pending_compiles = 0;
+}
+
+void ProgramShaderCache::CompileThreadFunc()
+{
+	s_compile_thread_id = std::this_thread::get_id();
+	Common::SetCurrentThreadName("Shader Compiler");
+
+	if (!GLInterface->MakeCurrentShared())
+	{
+		ERROR_LOG(VIDEO, "Failed to make the shared GL context current on the shader compile thread.");
+		return;
+	}
+
+	while (s_compile_thread_running.IsSet())
+	{
+		BackgroundCompileRequest req;
+		bool have_work = false;
+		{
+			std::lock_guard<std::mutex> lk(s_compile_lock);
+			if (s_compile_queue.empty())
+			{
+				s_compile_work_event.Reset();
+			}
+			else
+			{
+				req = std::move(s_compile_queue.front());
+				s_compile_queue.pop_front();
+				have_work = true;
+			}
+		}
+
+		if (!have_work)
+		{
+			// Recheck after the reset so a concurrent StopCompileThread can't be missed.
+			if (s_compile_thread_running.IsSet())
+				s_compile_work_event.Wait();
+			continue;
+		}
+
+		req.success = CompileAndLinkProgram(req.shader, req.vcode.c_str(), req.pcode.c_str(),
+		                                    req.has_gcode ? req.gcode.c_str() : nullptr);
+
+		// The program must be complete before another context may use it.
+		glFinish();
+
+		std::lock_guard<std::mutex> lk(s_compile_lock);
+		s_compile_results.push_back(std::move(req));
+	}
+
+	GLInterface->ClearCurrentShared();
+}
+
+void ProgramShaderCache::QueueBackgroundCompile(const SHADERUID& uid, const char* vcode, const char* pcode, const char* gcode)
+{
+	BackgroundCompileRequest req;
+	req.uid = uid;
+	req.vcode = vcode;
+	req.pcode = pcode;
+	req.has_gcode = gcode != nullptr;
+	if (gcode)
+		req.gcode = gcode;
+	req.success = false;
+
+	{
+		std::lock_guard<std::mutex> lk(s_compile_lock);
+		s_compile_queue.push_back(std::move(req));
+	}
+	s_num_pending_compiles++;
+	s_compile_work_event.Set();
+}
+
+void ProgramShaderCache::RetrieveBackgroundCompiles()
+{
+	std::vector<BackgroundCompileRequest> results;
+	std::vector<std::string> errors;
+	{
+		std::lock_guard<std::mutex> lk(s_compile_lock);
+		if (s_compile_results.empty())
+			return;
+		results.swap(s_compile_results);
+		errors.swap(s_compile_errors);
+	}
+
+	for (const std::string& error : errors)
+		PanicAlert("%s", error.c_str());
+
+	for (BackgroundCompileRequest& req : results)
+	{
+		s_num_pending_compiles--;
+
+		PCache::iterator iter = pshaders.find(req.uid);
+		if (iter == pshaders.end())
+		{
+			req.shader.Destroy();
+			continue;
+		}
+
+		PCacheEntry& entry = iter->second;
+		entry.pending = false;
+		if (!req.success)
+		{
+			GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
+			continue;
+		}
+
+		entry.shader.glprogid = req.shader.glprogid;
+		// Uniform block and sampler bindings may need the program bound, so
+		// they are set up on the video thread.
+		entry.shader.SetProgramVariables();
+
+		INCSTAT(stats.numPixelShadersCreated);
+	}
+	SETSTAT(stats.numPixelShadersAlive, pshaders.size());
+}
+
+// Stored as the three NUL-terminated vertex, pixel and geometry shader sources.
+void ProgramShaderCache::RecordShaderSource(const SHADERUID& uid, const char* vcode, const char* pcode, const char* gcode)
+{
+	if (!s_source_cache_open)
+		return;
+
+	std::string data;
+	data.append(vcode).push_back('\0');
+	data.append(pcode).push_back('\0');
+	if (gcode)
+		data.append(gcode);
+	data.push_back('\0');
+
+	g_program_source_cache.Append(uid, (const u8*)data.data(), (u32)data.size());
+}
+
+void ProgramShaderCache::PrecompileRecordedShaders(const std::string& cache_filename)
+{
+	ProgramShaderSourceReader reader;
+	g_program_source_cache.OpenAndRead(cache_filename, reader);
+	s_source_cache_open = true;
+
+	// Programs restored from the binary cache don't need to be rebuilt.
+	std::vector<ProgramShaderSourceReader::Entry> todo;
+	for (auto& entry : reader.entries)
+	{
+		if (pshaders.find(entry.uid) == pshaders.end())
+			todo.push_back(std::move(entry));
+	}
+
+	if (todo.empty())
+		return;
+
+	if (s_compile_thread_running.IsSet())
+	{
+		for (const auto& entry : todo)
+		{
+			if (pshaders.find(entry.uid) != pshaders.end())
+				continue;
+
+			PCacheEntry& newentry = pshaders[entry.uid];
+			newentry.in_cache = 0;
+			newentry.pending = true;
+			QueueBackgroundCompile(entry.uid, entry.vcode.c_str(), entry.pcode.c_str(),
+			                       entry.gcode.empty() ? nullptr : entry.gcode.c_str());
+		}
+		OSD::AddMessage(StringFromFormat("Compiling %u shaders in the background...", (u32)todo.size()), 5000);
+		return;
+	}
+
+	NOTICE_LOG(VIDEO, "Precompiling %u shader programs", (u32)todo.size());
+	u32 num_compiled = 0;
+	u32 last_progress = 0;
+	for (const auto& entry : todo)
+	{
+		if (pshaders.find(entry.uid) != pshaders.end())
+			continue;
+
+		PCacheEntry newentry;
+		newentry.in_cache = 0;
+		newentry.pending = false;
+		if (CompileShader(newentry.shader, entry.vcode.c_str(), entry.pcode.c_str(),
+		                  entry.gcode.empty() ? nullptr : entry.gcode.c_str()))
+		{
+			pshaders[entry.uid] = newentry;
+			INCSTAT(stats.numPixelShadersCreated);
+		}
+
+		u32 progress = ++num_compiled * 10 / (u32)todo.size();
+		if (progress != last_progress)
+		{
+			// No frame is drawn until we're done, so the OSD messages only show up
+			// afterwards. The title bar is updated by the host right away.
+			std::string message = StringFromFormat("Precompiling shaders: %u/%u", num_compiled, (u32)todo.size());
+			NOTICE_LOG(VIDEO, "%s", message.c_str());
+			OSD::AddMessage(message, 2000);
+			Host_UpdateTitle(message);
+			last_progress = progress;
+		}
+	}
+	SETSTAT(stats.numPixelShadersAlive, pshaders.size());
+	OSD::AddMessage(StringFromFormat("Precompiled %u shaders", num_compiled), 5000);
+}
+
 ProgramShaderCache::PCacheEntry ProgramShaderCache::GetShaderProgram()
 {
 	return *last_entry;
@@ -464,10 +775,26 @@ void ProgramShaderCache::Init()
 
 	CurrentProgram = 0;
 	last_entry = nullptr;
+
+	if (g_ActiveConfig.bBackgroundShaderCompiling && !g_ActiveConfig.bEnableShaderDebugging)
+		StartCompileThread();
+
+	// Compile everything the game used in previous sessions up front, so a
+	// cold or invalidated binary cache doesn't cause stutter in game.
+	if (!g_ActiveConfig.bEnableShaderDebugging)
+	{
+		if (!File::Exists(File::GetUserPath(D_SHADERCACHE_IDX)))
+			File::CreateDir(File::GetUserPath(D_SHADERCACHE_IDX));
+
+		PrecompileRecordedShaders(StringFromFormat("%sogl-%s-source.cache", File::GetUserPath(D_SHADERCACHE_IDX).c_str(),
+			SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID.c_str()));
+	}
 }
 
 void ProgramShaderCache::Shutdown()
 {
+	StopCompileThread();
+
 	// store all shaders in cache on disk
 	if (g_ogl_config.bSupportsGLSLCache && !g_Config.bEnableShaderDebugging)
 	{
@@ -506,6 +833,13 @@ void ProgramShaderCache::Shutdown()
 		g_program_disk_cache.Close();
 	}
 
+	if (s_source_cache_open)
+	{
+		g_program_source_cache.Sync();
+		g_program_source_cache.Close();
+		s_source_cache_open = false;
+	}
+
 	glUseProgram(0);
 
 	for (auto& entry : pshaders)
@@ -593,6 +927,7 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read(const SHADERUID& key,
 
 	PCacheEntry entry;
 	entry.in_cache = 1;
+	entry.pending = false;
 	entry.shader.glprogid = glCreateProgram();
 	glProgramBinary(entry.shader.glprogid, *prog_format, binary, binary_size);
 
@@ -611,4 +946,24 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read(const SHADERUID& key,
 }
 
 
+void ProgramShaderCache::ProgramShaderSourceReader::Read(const SHADERUID& key, const u8* value, u32 value_size)
+{
+	const char* str = (const char*)value;
+	const char* end = str + value_size;
+
+	Entry entry;
+	entry.uid = key;
+	std::string* fields[] = { &entry.vcode, &entry.pcode, &entry.gcode };
+	for (std::string* field : fields)
+	{
+		const char* terminator = std::find(str, end, '\0');
+		if (terminator == end)
+			return; // truncated entry
+		field->assign(str, terminator);
+		str = terminator + 1;
+	}
+
+	entries.push_back(std::move(entry));
+}
+
 } // namespace OGL
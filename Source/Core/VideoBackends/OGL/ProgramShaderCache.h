@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "Common/LinearDiskCache.h"
 #include "Core/ConfigManager.h"
 #include "VideoBackends/OGL/GLUtil.h"
@@ -77,6 +80,7 @@ public:
 	{
 		SHADER shader;
 		bool in_cache;
+		bool pending; // queued for background compilation, not usable yet
 
 		void Destroy()
 		{
@@ -92,6 +96,7 @@ public:
 	static void GetShaderId(SHADERUID *uid, DSTALPHA_MODE dstAlphaMode, u32 components, u32 primitive_type);
 
 	static bool CompileShader(SHADER &shader, const char* vcode, const char* pcode, const char* gcode = nullptr);
+	static bool CompileAndLinkProgram(SHADER &shader, const char* vcode, const char* pcode, const char* gcode = nullptr);
 	static GLuint CompileSingleShader(GLuint type, const char *code);
 	static void UploadConstants(bool force_upload);
 
@@ -100,12 +105,35 @@ public:
 	static void CreateHeader();
 
 private:
+	static void StartCompileThread();
+	static void StopCompileThread();
+	static void CompileThreadFunc();
+	static void QueueBackgroundCompile(const SHADERUID& uid, const char* vcode, const char* pcode, const char* gcode);
+	static void RetrieveBackgroundCompiles();
+	static void RecordShaderSource(const SHADERUID& uid, const char* vcode, const char* pcode, const char* gcode);
+	static void PrecompileRecordedShaders(const std::string& cache_filename);
+
 	class ProgramShaderCacheInserter : public LinearDiskCacheReader<SHADERUID, u8>
 	{
 	public:
 		void Read(const SHADERUID &key, const u8 *value, u32 value_size) override;
 	};
 
+	// Collects the recorded GLSL source of programs used by the game in
+	// previous sessions, so they can be compiled before they are needed.
+	class ProgramShaderSourceReader : public LinearDiskCacheReader<SHADERUID, u8>
+	{
+	public:
+		struct Entry
+		{
+			SHADERUID uid;
+			std::string vcode, pcode, gcode;
+		};
+		std::vector<Entry> entries;
+
+		void Read(const SHADERUID &key, const u8 *value, u32 value_size) override;
+	};
+
 	static PCache pshaders;
 	static PCacheEntry* last_entry;
 	static SHADERUID last_uid;
@@ -40,6 +40,7 @@
 #include "VideoBackends/OGL/TextureConverter.h"
 #include "VideoBackends/OGL/VertexManager.h"
 
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/BPStructs.h"
 #include "VideoCommon/DriverDetails.h"
@@ -113,6 +114,28 @@ static bool s_efbCacheValid[2][EFB_CACHE_WIDTH * EFB_CACHE_HEIGHT];
 static bool s_efbCacheIsCleared = false;
 static std::vector<u32> s_efbCache[2][EFB_CACHE_WIDTH * EFB_CACHE_HEIGHT]; // 2 for PEEK_Z and PEEK_COLOR
 
+// Asynchronous EFB peeks: the whole EFB is read back at native resolution once
+// per segment of EFB modifications, and peeks are answered from the newest
+// finished readback as long as it isn't older than iEFBPeekLatency frames.
+static const int EFB_READBACK_COUNT = 3;
+struct EFBReadback
+{
+	GLuint pbo[2]; // PEEK_Z and PEEK_COLOR, like s_efbCache
+	GLsync fence;
+	u64 frame;
+};
+static EFBReadback s_efbReadbacks[EFB_READBACK_COUNT];
+static int s_efbReadbackNext = 0; // also the oldest one in flight
+static GLuint s_efbReadbackFramebuffer = 0;
+static GLuint s_efbReadbackTextures[2];
+static std::vector<u32> s_efbReadbackData[2]; // top row first
+static u64 s_efbReadbackDataFrame = 0;
+static bool s_efbReadbackDataValid = false;
+static bool s_efbReadbackDataCurrent = false; // nothing was drawn since the data was read
+static bool s_efbReadbackNeeded = true; // something was drawn since the last readback was started
+static u64 s_efbFrameCount = 0;
+static void DestroyEFBReadbacks();
+
 static int GetNumMSAASamples(int MSAAMode)
 {
 	int samples;
@@ -478,6 +501,15 @@ Renderer::Renderer()
 	g_Config.backend_info.bSupportsGeometryShaders = GLExtensions::Version() >= 320;
 	g_Config.backend_info.bSupportsPaletteConversion = GLExtensions::Supports("GL_ARB_texture_buffer_object");
 
+	// GPU texture decoding reads the raw texture data bytewise from a buffer texture
+	g_Config.backend_info.bSupportsGPUTextureDecoding = false;
+	if (g_Config.backend_info.bSupportsPaletteConversion)
+	{
+		GLint max_texture_buffer_size = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texture_buffer_size);
+		g_Config.backend_info.bSupportsGPUTextureDecoding = max_texture_buffer_size >= (GLint)TextureCache::DECODING_BUFFER_SIZE;
+	}
+
 	// Desktop OpenGL supports the binding layout if it supports 420pack
 	// OpenGL ES 3.1 supports it implicitly without an extension
 	g_Config.backend_info.bSupportsBindingLayout = GLExtensions::Supports("GL_ARB_shading_language_420pack");
@@ -716,6 +748,7 @@ void Renderer::Shutdown()
 	}
 	g_first_rift_frame = true;
 
+	DestroyEFBReadbacks();
 	delete g_framebuffer_manager;
 
 	g_Config.bRunning = false;
@@ -968,6 +1001,202 @@ void ClearEFBCache()
 		s_efbCacheIsCleared = true;
 		memset(s_efbCacheValid, 0, sizeof(s_efbCacheValid));
 	}
+	s_efbReadbackNeeded = true;
+	s_efbReadbackDataCurrent = false;
+}
+
+static void FinishEFBReadback(EFBReadback& readback)
+{
+	glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+	glDeleteSync(readback.fence);
+	readback.fence = 0;
+
+	bool mapped = true;
+	for (int i = 0; i < 2; i++)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo[i]);
+		const u32* src = (const u32*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, EFB_WIDTH * EFB_HEIGHT * sizeof(u32), GL_MAP_READ_BIT);
+		if (!src)
+		{
+			mapped = false;
+			continue;
+		}
+
+		s_efbReadbackData[i].resize(EFB_WIDTH * EFB_HEIGHT);
+		for (u32 y = 0; y < EFB_HEIGHT; ++y)
+		{
+			// OpenGL rows start at the bottom
+			const u32* row = src + (EFB_HEIGHT - 1 - y) * EFB_WIDTH;
+			u32* dst = &s_efbReadbackData[i][y * EFB_WIDTH];
+			if (i == 0)
+			{
+				const float* depth = (const float*)row;
+				for (u32 x = 0; x < EFB_WIDTH; ++x)
+					dst[x] = MathUtil::Clamp<u32>((u32)(depth[x] * 16777216.0f), 0, 0xFFFFFF);
+			}
+			else
+			{
+				memcpy(dst, row, EFB_WIDTH * sizeof(u32));
+			}
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	const EFBReadback& newest = s_efbReadbacks[(s_efbReadbackNext + EFB_READBACK_COUNT - 1) % EFB_READBACK_COUNT];
+	s_efbReadbackDataValid = mapped;
+	s_efbReadbackDataFrame = readback.frame;
+	s_efbReadbackDataCurrent = mapped && &readback == &newest && !s_efbReadbackNeeded;
+}
+
+// Takes the results of the readbacks which have finished, oldest first.
+// If wait is set, waits for all of them instead.
+static void UpdateEFBReadbackData(bool wait)
+{
+	for (int i = 0; i < EFB_READBACK_COUNT; i++)
+	{
+		EFBReadback& readback = s_efbReadbacks[(s_efbReadbackNext + i) % EFB_READBACK_COUNT];
+		if (!readback.fence)
+			continue;
+		if (!wait && glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED)
+			break;
+		FinishEFBReadback(readback);
+	}
+}
+
+static void StartEFBReadback()
+{
+	if (!s_efbReadbackFramebuffer)
+	{
+		glGenTextures(2, s_efbReadbackTextures);
+		glActiveTexture(GL_TEXTURE0 + 9);
+		glBindTexture(GL_TEXTURE_2D, s_efbReadbackTextures[0]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, EFB_WIDTH, EFB_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+		glBindTexture(GL_TEXTURE_2D, s_efbReadbackTextures[1]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, EFB_WIDTH, EFB_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+		glGenFramebuffers(1, &s_efbReadbackFramebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, s_efbReadbackFramebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, s_efbReadbackTextures[0], 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, s_efbReadbackTextures[1], 0);
+
+		for (EFBReadback& readback : s_efbReadbacks)
+		{
+			glGenBuffers(2, readback.pbo);
+			for (GLuint pbo : readback.pbo)
+			{
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+				glBufferData(GL_PIXEL_PACK_BUFFER, EFB_WIDTH * EFB_HEIGHT * sizeof(u32), nullptr, GL_STREAM_READ);
+			}
+			readback.fence = 0;
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	// All readbacks are in flight, wait for the oldest one
+	EFBReadback& readback = s_efbReadbacks[s_efbReadbackNext];
+	if (readback.fence)
+		FinishEFBReadback(readback);
+
+	g_renderer->ResetAPIState();
+
+	// Downsample to native resolution, picking the center pixel like UpdateEFBCache
+	EFBRectangle efbRc(0, 0, EFB_WIDTH, EFB_HEIGHT);
+	TargetRectangle targetRc = g_renderer->ConvertEFBRectangle(efbRc);
+	GLuint srcFramebuffer = FramebufferManager::GetEFBFramebuffer();
+	if (s_MSAASamples > 1)
+	{
+		FramebufferManager::GetEFBColorTexture(efbRc);
+		FramebufferManager::GetEFBDepthTexture(efbRc);
+		srcFramebuffer = FramebufferManager::GetResolvedFramebuffer();
+	}
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, srcFramebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, s_efbReadbackFramebuffer);
+	glBlitFramebuffer(targetRc.left, targetRc.bottom, targetRc.right, targetRc.top,
+	                  0, 0, EFB_WIDTH, EFB_HEIGHT, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, s_efbReadbackFramebuffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo[0]);
+	glReadPixels(0, 0, EFB_WIDTH, EFB_HEIGHT, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo[1]);
+	// XXX: Swap colours
+	if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
+		glReadPixels(0, 0, EFB_WIDTH, EFB_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	else
+		glReadPixels(0, 0, EFB_WIDTH, EFB_HEIGHT, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	readback.frame = s_efbFrameCount;
+	s_efbReadbackNext = (s_efbReadbackNext + 1) % EFB_READBACK_COUNT;
+	s_efbReadbackNeeded = false;
+
+	FramebufferManager::SetFramebuffer(0);
+	g_renderer->RestoreAPIState();
+}
+
+static bool IsEFBReadbackDataUsable()
+{
+	if (!s_efbReadbackDataValid)
+		return false;
+	if (g_ActiveConfig.iEFBPeekLatency <= 0)
+		return s_efbReadbackDataCurrent;
+	return s_efbFrameCount - s_efbReadbackDataFrame <= (u64)g_ActiveConfig.iEFBPeekLatency;
+}
+
+// Fills a rectangle of the EFB cache from the newest usable readback. Starts a
+// new readback first if the EFB has changed since the last one, so that the
+// next peeks have something more recent.
+static bool LoadEFBCacheFromReadback(u32 cacheType, u32 cacheRectIdx, const EFBRectangle& efbPixelRc)
+{
+	if (s_efbReadbackNeeded)
+		StartEFBReadback();
+
+	UpdateEFBReadbackData(false);
+	if (!IsEFBReadbackDataUsable())
+	{
+		// Nothing recent enough has finished yet
+		UpdateEFBReadbackData(true);
+		if (!IsEFBReadbackDataUsable())
+			return false;
+	}
+
+	if (!s_efbCache[cacheType][cacheRectIdx].size())
+		s_efbCache[cacheType][cacheRectIdx].resize(EFB_CACHE_RECT_SIZE * EFB_CACHE_RECT_SIZE);
+
+	int efbPixelRcWidth = efbPixelRc.right - efbPixelRc.left;
+	for (int yEFB = efbPixelRc.top; yEFB < efbPixelRc.bottom; ++yEFB)
+	{
+		memcpy(&s_efbCache[cacheType][cacheRectIdx][(yEFB - efbPixelRc.top) * EFB_CACHE_RECT_SIZE],
+		       &s_efbReadbackData[cacheType][yEFB * EFB_WIDTH + efbPixelRc.left], efbPixelRcWidth * sizeof(u32));
+	}
+
+	s_efbCacheValid[cacheType][cacheRectIdx] = true;
+	s_efbCacheIsCleared = false;
+	return true;
+}
+
+static void DestroyEFBReadbacks()
+{
+	if (!s_efbReadbackFramebuffer)
+		return;
+
+	for (EFBReadback& readback : s_efbReadbacks)
+	{
+		if (readback.fence)
+			glDeleteSync(readback.fence);
+		readback.fence = 0;
+		glDeleteBuffers(2, readback.pbo);
+	}
+	glDeleteFramebuffers(1, &s_efbReadbackFramebuffer);
+	glDeleteTextures(2, s_efbReadbackTextures);
+	s_efbReadbackFramebuffer = 0;
+	s_efbReadbackNext = 0;
+	s_efbReadbackDataValid = false;
+	s_efbReadbackDataCurrent = false;
+	s_efbReadbackNeeded = true;
 }
 
 void Renderer::UpdateEFBCache(EFBAccessType type, u32 cacheRectIdx, const EFBRectangle& efbPixelRc, const TargetRectangle& targetPixelRc, const void* data)
@@ -1039,6 +1268,10 @@ u32 Renderer::AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data)
 		efbPixelRc.top = (y / EFB_CACHE_RECT_SIZE) * EFB_CACHE_RECT_SIZE;
 		efbPixelRc.right = std::min(efbPixelRc.left + EFB_CACHE_RECT_SIZE, (u32)EFB_WIDTH);
 		efbPixelRc.bottom = std::min(efbPixelRc.top + EFB_CACHE_RECT_SIZE, (u32)EFB_HEIGHT);
+
+		u32 cacheType = (type == PEEK_Z ? 0 : 1);
+		if (g_ActiveConfig.bAsyncEFBPeeks && g_ogl_config.bSupportsGLSync && !s_efbCacheValid[cacheType][cacheRectIdx])
+			LoadEFBCacheFromReadback(cacheType, cacheRectIdx, efbPixelRc);
 	}
 	else
 	{
@@ -1215,7 +1448,17 @@ u16 Renderer::BBoxRead(int index)
 
 	// Here we get the min/max value of the truncated position of the upscaled and swapped framebuffer.
 	// So we have to correct them to the unscaled EFB sizes.
-	int value = BoundingBox::Get(swapped_index);
+	int value;
+	if (g_ActiveConfig.iBBoxMode == BBOX_ASYNC && g_ogl_config.bSupportsGLSync)
+	{
+		// Nothing was read back yet, the CPU estimate is all there is.
+		if (!BoundingBox::GetLatest(swapped_index, &value))
+			return ::BoundingBox::coords[index];
+	}
+	else
+	{
+		value = BoundingBox::Get(swapped_index);
+	}
 
 	if (index < 2)
 	{
@@ -1669,6 +1912,9 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 			glDisable(GL_DEBUG_OUTPUT);
 	}
 
+	// Don't keep EFB copies to RAM on the GPU for longer than a frame
+	g_texture_cache->FlushAllEFBCopies();
+
 	if (g_first_rift_frame && g_has_rift && g_ActiveConfig.bEnableVR)
 	{
 		if (!g_ActiveConfig.bAsynchronousTimewarp)
@@ -2261,6 +2507,7 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 
 	// Invalidate EFB cache
 	ClearEFBCache();
+	s_efbFrameCount++;
 }
 
 // ALWAYS call RestoreAPIState for each ResetAPIState call you're doing
@@ -28,6 +28,7 @@ StreamBuffer::StreamBuffer(u32 type, u32 size)
 	m_iterator = 0;
 	m_used_iterator = 0;
 	m_free_iterator = 0;
+	m_generation = 0;
 }
 
 
@@ -105,6 +106,7 @@ void StreamBuffer::AllocMemory(u32 size)
 
 		// move to the start
 		m_used_iterator = m_iterator = 0; // offset 0 is always aligned
+		m_generation++;
 
 		// wait for space at the start
 		for (int i = 0; i <= SLOT(m_iterator + size); i++)
@@ -142,6 +144,7 @@ public:
 		{
 			glBufferData(m_buffertype, m_size, nullptr, GL_STREAM_DRAW);
 			m_iterator = 0;
+			m_generation++;
 		}
 		u8* pointer = (u8*)glMapBufferRange(m_buffertype, m_iterator, size,
 			GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
@@ -312,6 +315,8 @@ public:
 
 	std::pair<u8*, u32> Map(u32 size) override
 	{
+		// every upload overwrites the previous one
+		m_generation++;
 		return std::make_pair(m_pointer, 0);
 	}
 
@@ -344,6 +349,8 @@ public:
 
 	std::pair<u8*, u32> Map(u32 size) override
 	{
+		// every upload overwrites the previous one
+		m_generation++;
 		return std::make_pair(m_pointer, 0);
 	}
 
@@ -40,6 +40,10 @@ public:
 		return Map(size);
 	}
 
+	// Incremented whenever data written before may have been overwritten or
+	// orphaned. Ranges uploaded within the current generation are still valid.
+	u32 GetGeneration() const { return m_generation; }
+
 	const u32 m_buffer;
 
 protected:
@@ -54,6 +58,7 @@ protected:
 	u32 m_iterator;
 	u32 m_used_iterator;
 	u32 m_free_iterator;
+	u32 m_generation;
 
 private:
 	static const int SYNC_POINTS = 16;
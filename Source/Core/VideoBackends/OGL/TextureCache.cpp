@@ -2,8 +2,10 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <map>
 #include <vector>
 
 #include "Common/CommonPaths.h"
@@ -12,6 +14,7 @@
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
 
+#include "Core/ConfigManager.h"
 #include "Core/HW/Memmap.h"
 
 #include "VideoBackends/OGL/FramebufferManager.h"
@@ -23,9 +26,11 @@
 #include "VideoBackends/OGL/TextureConverter.h"
 
 #include "VideoCommon/BPStructs.h"
+#include "VideoCommon/Fifo.h"
 #include "VideoCommon/HiresTextures.h"
 #include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/Statistics.h"
+#include "VideoCommon/TextureConversionShader.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -51,6 +56,20 @@ static GLuint s_palette_buffer_offset_uniform[3];
 static GLuint s_palette_multiplier_uniform[3];
 static GLuint s_palette_copy_position_uniform[3];
 
+struct DecodingShader
+{
+	SHADER shader;
+	GLint params_uniform;
+	bool valid;
+};
+// Compiled on first use, indexed by texture format | (palette format << 16)
+static std::map<u32, DecodingShader> s_decoding_shaders;
+static StreamBuffer* s_decoding_stream_buffer = nullptr;
+static GLuint s_decoding_buffer_texture;
+
+// EFB copies to RAM which are still in their PBOs, oldest first
+static std::vector<TextureCache::TCacheEntryBase*> s_pending_copies;
+
 bool SaveTexture(const std::string& filename, u32 textarget, u32 tex, int virtual_width, int virtual_height, unsigned int level)
 {
 	if (GLInterface->GetMode() != GLInterfaceMode::MODE_OPENGL)
@@ -69,6 +88,13 @@ bool SaveTexture(const std::string& filename, u32 textarget, u32 tex, int virtua
 
 TextureCache::TCacheEntry::~TCacheEntry()
 {
+	// Entries are only deleted when the cache is invalidated or shut down. After
+	// a savestate load, writing the copy would clobber the loaded RAM.
+	if (readback_pending)
+		DiscardPendingCopy(this);
+	if (readback.pbo)
+		glDeleteBuffers(1, &readback.pbo);
+
 	if (texture)
 	{
 		for (auto& gtex : s_Textures)
@@ -91,6 +117,7 @@ TextureCache::TCacheEntry::TCacheEntry(const TCacheEntryConfig& _config)
 	glGenTextures(1, &texture);
 
 	framebuffer = 0;
+	readback_pending = false;
 }
 
 void TextureCache::TCacheEntry::Bind(unsigned int stage)
@@ -124,9 +151,10 @@ TextureCache::TCacheEntryBase* TextureCache::CreateTexture(const TCacheEntryConf
 
 	if (config.rendertarget)
 	{
-		for (u32 level = 0; level <= config.levels; level++)
+		for (u32 level = 0; level < config.levels; level++)
 		{
-			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA, config.width, config.height, config.layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA, std::max(config.width >> level, 1u), std::max(config.height >> level, 1u),
+			             config.layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
 		}
 		glGenFramebuffers(1, &entry->framebuffer);
 		FramebufferManager::SetFramebuffer(entry->framebuffer);
@@ -207,6 +235,21 @@ void TextureCache::TCacheEntry::FromRenderTarget(u32 dstAddr, unsigned int dstFo
 
 	if (!g_ActiveConfig.bSkipEFBCopyToRam)
 	{
+		// Leave the encoded data in a PBO until something needs it, so that we
+		// don't have to wait for the GPU here. With the deterministic GPU thread
+		// the CPU doesn't wait for the GPU at tokens, so there's no safe point.
+		// In single core mode there's no GPU thread to flush them on before a
+		// savestate is made.
+		const bool defer = g_ActiveConfig.bDeferEFBCopies && g_ogl_config.bSupportsGLSync &&
+		                   SConfig::GetInstance().m_LocalCoreStartupParameter.bCPUThread &&
+		                   !g_use_deterministic_gpu_thread;
+
+		// Older copies must not land on top of this one, and our PBO gets reused.
+		if (!defer)
+			g_texture_cache->FlushAllEFBCopies();
+		else if (readback_pending)
+			FinishPendingCopiesUpTo(this);
+
 		int encoded_size = TextureConverter::EncodeToRamFromTexture(
 			dstAddr,
 			read_texture,
@@ -214,16 +257,24 @@ void TextureCache::TCacheEntry::FromRenderTarget(u32 dstAddr, unsigned int dstFo
 			isIntensity,
 			dstFormat,
 			scaleByHalf,
-			srcRect);
-
-		u8* dst = Memory::GetPointer(dstAddr);
-		u64 const new_hash = GetHash64(dst,encoded_size,g_ActiveConfig.iSafeTextureCache_ColorSamples);
+			srcRect,
+			defer ? &readback : nullptr);
 
 		size_in_bytes = (u32)encoded_size;
 
 		TextureCache::MakeRangeDynamic(dstAddr, encoded_size);
 
-		hash = new_hash;
+		if (defer)
+		{
+			// The hash is set once the data is in RAM
+			readback_pending = true;
+			s_pending_copies.push_back(this);
+		}
+		else
+		{
+			u8* dst = Memory::GetPointer(dstAddr);
+			hash = GetHash64(dst, encoded_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+		}
 	}
 
 	FramebufferManager::SetFramebuffer(0);
@@ -231,6 +282,60 @@ void TextureCache::TCacheEntry::FromRenderTarget(u32 dstAddr, unsigned int dstFo
 	g_renderer->RestoreAPIState();
 }
 
+void TextureCache::FlushEFBCopies(u32 address, u32 size)
+{
+	// Copies have to land in the order they were made, so write out everything
+	// up to the last one which overlaps the range.
+	size_t count = 0;
+	for (size_t i = 0; i < s_pending_copies.size(); i++)
+	{
+		const TextureConverter::PendingReadback& readback = static_cast<TCacheEntry*>(s_pending_copies[i])->readback;
+		if ((u64)readback.address < (u64)address + size && (u64)address < (u64)readback.address + readback.ram_size)
+			count = i + 1;
+	}
+	FinishPendingCopies(count);
+}
+
+void TextureCache::FinishPendingCopies(size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		TCacheEntry* entry = static_cast<TCacheEntry*>(s_pending_copies[i]);
+		TextureConverter::FinishReadback(&entry->readback);
+		entry->readback_pending = false;
+
+		// Unless the entry was reused for something else in the meantime
+		u8* dst = Memory::GetPointer(entry->readback.address);
+		if (dst && entry->is_efb_copy && entry->addr == entry->readback.address)
+			entry->hash = GetHash64(dst, entry->size_in_bytes, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+	}
+	s_pending_copies.erase(s_pending_copies.begin(), s_pending_copies.begin() + count);
+}
+
+void TextureCache::FinishPendingCopiesUpTo(TCacheEntry* entry)
+{
+	auto it = std::find(s_pending_copies.begin(), s_pending_copies.end(), entry);
+	if (it != s_pending_copies.end())
+		FinishPendingCopies(it - s_pending_copies.begin() + 1);
+}
+
+void TextureCache::DiscardPendingCopy(TCacheEntry* entry)
+{
+	glDeleteSync(entry->readback.fence);
+	entry->readback.fence = 0;
+	entry->readback_pending = false;
+
+	auto it = std::find(s_pending_copies.begin(), s_pending_copies.end(), entry);
+	if (it != s_pending_copies.end())
+		s_pending_copies.erase(it);
+}
+
+void TextureCache::DiscardEFBCopies()
+{
+	while (!s_pending_copies.empty())
+		DiscardPendingCopy(static_cast<TCacheEntry*>(s_pending_copies.back()));
+}
+
 TextureCache::TextureCache()
 {
 	CompileShaders();
@@ -246,6 +351,14 @@ TextureCache::TextureCache()
 		glBindTexture(GL_TEXTURE_BUFFER, s_palette_resolv_texture);
 		glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, s_palette_stream_buffer->m_buffer);
 	}
+
+	if (g_ActiveConfig.backend_info.bSupportsGPUTextureDecoding)
+	{
+		s_decoding_stream_buffer = StreamBuffer::Create(GL_TEXTURE_BUFFER, DECODING_BUFFER_SIZE);
+		glGenTextures(1, &s_decoding_buffer_texture);
+		glBindTexture(GL_TEXTURE_BUFFER, s_decoding_buffer_texture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_R8UI, s_decoding_stream_buffer->m_buffer);
+	}
 }
 
 
@@ -259,6 +372,13 @@ TextureCache::~TextureCache()
 		s_palette_stream_buffer = nullptr;
 		glDeleteTextures(1, &s_palette_resolv_texture);
 	}
+
+	if (g_ActiveConfig.backend_info.bSupportsGPUTextureDecoding)
+	{
+		delete s_decoding_stream_buffer;
+		s_decoding_stream_buffer = nullptr;
+		glDeleteTextures(1, &s_decoding_buffer_texture);
+	}
 }
 
 void TextureCache::DisableStage(unsigned int stage)
@@ -475,6 +595,10 @@ void TextureCache::DeleteShaders()
 	if (g_ActiveConfig.backend_info.bSupportsPaletteConversion)
 		for (auto& shader : s_palette_pixel_shader)
 			shader.Destroy();
+
+	for (auto& it : s_decoding_shaders)
+		it.second.shader.Destroy();
+	s_decoding_shaders.clear();
 }
 
 void TextureCache::ConvertTexture(TCacheEntryBase* _entry, TCacheEntryBase* _unconverted, void* palette, TlutFormat format)
@@ -512,4 +636,87 @@ void TextureCache::ConvertTexture(TCacheEntryBase* _entry, TCacheEntryBase* _unc
 	g_renderer->RestoreAPIState();
 }
 
+static DecodingShader& GetDecodingShader(int format, TlutFormat palette_format)
+{
+	const bool is_palette = format == GX_TF_C4 || format == GX_TF_C8 || format == GX_TF_C14X2;
+	const u32 key = is_palette ? format | (palette_format << 16) : format;
+
+	auto it = s_decoding_shaders.find(key);
+	if (it != s_decoding_shaders.end())
+		return it->second;
+
+	DecodingShader& decoder = s_decoding_shaders[key];
+	decoder.valid = false;
+
+	const char* pcode = TextureConversionShader::GenerateDecodingShader(format, palette_format, API_OPENGL);
+	if (!pcode)
+		return decoder;
+
+	const char* vcode =
+		"void main()\n"
+		"{\n"
+		"	vec2 rawpos = vec2(gl_VertexID&1, gl_VertexID&2);\n"
+		"	gl_Position = vec4(rawpos*2.0-1.0, 0.0, 1.0);\n"
+		"}\n";
+
+	decoder.valid = ProgramShaderCache::CompileShader(decoder.shader, vcode, pcode);
+	if (decoder.valid)
+		decoder.params_uniform = glGetUniformLocation(decoder.shader.glprogid, "decode_params");
+	else
+		ERROR_LOG(VIDEO, "Failed to compile the texture decoding shader for format 0x%x", key);
+
+	return decoder;
+}
+
+bool TextureCache::SupportsGPUTextureDecode(int format, TlutFormat palette_format, u32 data_size)
+{
+	// The palette is uploaded along with the data, and both have to fit into the buffer
+	if (data_size + TexDecoder_GetPaletteSize(format) > DECODING_BUFFER_SIZE)
+		return false;
+
+	return GetDecodingShader(format, palette_format).valid;
+}
+
+void TextureCache::DecodeTextureOnGPU(TCacheEntryBase* _entry, u32 dst_level, const u8* data, u32 data_size,
+	int format, u32 width, u32 height, u32 aligned_width, u32 aligned_height,
+	const u8* palette, TlutFormat palette_format)
+{
+	TCacheEntry* entry = (TCacheEntry*) _entry;
+	DecodingShader& decoder = GetDecodingShader(format, palette_format);
+	const u32 palette_size = TexDecoder_GetPaletteSize(format);
+	const bool is_palette = palette_size != 0;
+	const u32 upload_size = data_size + palette_size;
+	_assert_msg_(VIDEO, decoder.valid && upload_size <= DECODING_BUFFER_SIZE,
+		"Texture format 0x%x can't be decoded on the GPU", format);
+
+	g_renderer->ResetAPIState();
+
+	// The palette is appended to the texture data in the same upload
+	auto buffer = s_decoding_stream_buffer->Map(upload_size);
+	memcpy(buffer.first, data, data_size);
+	if (is_palette)
+		memcpy(buffer.first + data_size, palette, palette_size);
+	s_decoding_stream_buffer->Unmap(upload_size);
+
+	FramebufferManager::SetFramebuffer(entry->framebuffer);
+	if (dst_level != 0)
+		FramebufferManager::FramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_ARRAY, entry->texture, dst_level);
+	glViewport(0, 0, width, height);
+
+	decoder.shader.Bind();
+	glUniform4i(decoder.params_uniform, buffer.second, aligned_width / TexDecoder_GetBlockWidthInTexels(format),
+	            buffer.second + data_size, 0);
+
+	glActiveTexture(GL_TEXTURE0 + 10);
+	glBindTexture(GL_TEXTURE_BUFFER, s_decoding_buffer_texture);
+
+	OpenGL_BindAttributelessVAO();
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	if (dst_level != 0)
+		FramebufferManager::FramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_ARRAY, entry->texture, 0);
+	FramebufferManager::SetFramebuffer(0);
+	g_renderer->RestoreAPIState();
+}
+
 }
@@ -7,6 +7,7 @@
 #include <map>
 
 #include "VideoBackends/OGL/GLUtil.h"
+#include "VideoBackends/OGL/TextureConverter.h"
 #include "VideoCommon/BPStructs.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VideoCommon.h"
@@ -21,12 +22,19 @@ public:
 	static void DisableStage(unsigned int stage);
 	static void SetStage();
 
+	// Size of the buffer texture which GPU texture decoding reads the raw data from
+	static const u32 DECODING_BUFFER_SIZE = 16 * 1024 * 1024;
+
 private:
 	struct TCacheEntry : TCacheEntryBase
 	{
 		GLuint texture;
 		GLuint framebuffer;
 
+		// Deferred EFB copy to RAM, see FlushEFBCopies()
+		TextureConverter::PendingReadback readback;
+		bool readback_pending;
+
 		//TexMode0 mode; // current filter and clamp modes that texture is set to
 		//TexMode1 mode1; // current filter and clamp modes that texture is set to
 
@@ -50,8 +58,20 @@ private:
 	TCacheEntryBase* CreateTexture(const TCacheEntryConfig& config) override;
 	void ConvertTexture(TCacheEntryBase* entry, TCacheEntryBase* unconverted, void* palette, TlutFormat format) override;
 
+	bool SupportsGPUTextureDecode(int format, TlutFormat palette_format, u32 data_size) override;
+	void DecodeTextureOnGPU(TCacheEntryBase* entry, u32 dst_level, const u8* data, u32 data_size,
+		int format, u32 width, u32 height, u32 aligned_width, u32 aligned_height,
+		const u8* palette, TlutFormat palette_format) override;
+
 	void CompileShaders() override;
 	void DeleteShaders() override;
+
+	void FlushEFBCopies(u32 address, u32 size) override;
+	void DiscardEFBCopies() override;
+	// Writes the oldest count pending EFB copies to RAM
+	static void FinishPendingCopies(size_t count);
+	static void FinishPendingCopiesUpTo(TCacheEntry* entry);
+	static void DiscardPendingCopy(TCacheEntry* entry);
 };
 
 bool SaveTexture(const std::string& filename, u32 textarget, u32 tex, int virtual_width, int virtual_height, unsigned int level);
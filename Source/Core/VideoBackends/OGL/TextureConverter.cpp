@@ -214,7 +214,7 @@ void Shutdown()
 
 static void EncodeToRamUsingShader(GLuint srcTexture,
 						u8* destAddr, int dstWidth, int dstHeight, int readStride,
-						bool linearFilter)
+						bool linearFilter, PendingReadback* deferred = nullptr)
 {
 
 
@@ -251,6 +251,33 @@ static void EncodeToRamUsingShader(GLuint srcTexture,
 	int readHeight = readStride / dstWidth / 4; // 4 bytes per pixel
 	int readLoops = dstHeight / readHeight;
 
+	if (deferred)
+	{
+		// Only queue the transfer into the PBO, the fence tells when it's done
+		if (!deferred->pbo)
+			glGenBuffers(1, &deferred->pbo);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, deferred->pbo);
+		glBufferData(GL_PIXEL_PACK_BUFFER, dstSize, nullptr, GL_STREAM_READ);
+		glReadPixels(0, 0, (GLsizei)dstWidth, (GLsizei)dstHeight, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		deferred->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		if (writeStride != readStride && readLoops > 1)
+		{
+			deferred->read_stride = readStride;
+			deferred->write_stride = writeStride;
+			deferred->num_rows = readLoops;
+		}
+		else
+		{
+			deferred->read_stride = dstSize;
+			deferred->write_stride = dstSize;
+			deferred->num_rows = 1;
+		}
+		deferred->ram_size = (deferred->num_rows - 1) * deferred->write_stride + deferred->read_stride;
+		return;
+	}
+
 	if (writeStride != readStride && readLoops > 1)
 	{
 		// writing to a texture of a different size
@@ -279,7 +306,8 @@ static void EncodeToRamUsingShader(GLuint srcTexture,
 	}
 }
 
-int EncodeToRamFromTexture(u32 address,GLuint source_texture, bool bFromZBuffer, bool bIsIntensityFmt, u32 copyfmt, int bScaleByHalf, const EFBRectangle& source)
+int EncodeToRamFromTexture(u32 address,GLuint source_texture, bool bFromZBuffer, bool bIsIntensityFmt, u32 copyfmt, int bScaleByHalf, const EFBRectangle& source,
+                           PendingReadback* deferred)
 {
 	u32 format = copyfmt;
 
@@ -327,13 +355,38 @@ int EncodeToRamFromTexture(u32 address,GLuint source_texture, bool bFromZBuffer,
 	else
 		cacheLinesPerRow = numBlocksX;
 
+	if (deferred)
+		deferred->address = address;
 	EncodeToRamUsingShader(source_texture,
 		dest_ptr, cacheLinesPerRow * 8, numBlocksY, cacheLinesPerRow * 32,
-		bScaleByHalf > 0 && !bFromZBuffer);
+		bScaleByHalf > 0 && !bFromZBuffer, deferred);
 	return size_in_bytes; // TODO: D3D11 is calculating this value differently!
 
 }
 
+void FinishReadback(PendingReadback* readback)
+{
+	glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+	glDeleteSync(readback->fence);
+	readback->fence = 0;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+	const u8* pbo = (const u8*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback->read_stride * readback->num_rows, GL_MAP_READ_BIT);
+	u8* dst = Memory::GetPointer(readback->address);
+	if (pbo)
+	{
+		const u8* src = pbo;
+		for (int i = 0; dst && i < readback->num_rows; i++)
+		{
+			memcpy(dst, src, readback->read_stride);
+			src += readback->read_stride;
+			dst += readback->write_stride;
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
 void EncodeToRamYUYV(GLuint srcTexture, const TargetRectangle& sourceRc, u8* destAddr, int dstWidth, int dstHeight)
 {
 	g_renderer->ResetAPIState();
@@ -15,6 +15,21 @@ namespace OGL
 namespace TextureConverter
 {
 
+// The encoded data of an EFB copy which was read back into a PBO, but hasn't
+// been written to RAM yet.
+struct PendingReadback
+{
+	PendingReadback() : pbo(0), fence(0), address(0), ram_size(0), read_stride(0), write_stride(0), num_rows(0) {}
+
+	GLuint pbo;
+	GLsync fence;
+	u32 address;
+	u32 ram_size;
+	int read_stride;
+	int write_stride;
+	int num_rows;
+};
+
 void Init();
 void Shutdown();
 
@@ -24,7 +39,11 @@ void EncodeToRamYUYV(GLuint srcTexture, const TargetRectangle& sourceRc,
 void DecodeToTexture(u32 xfbAddr, int srcWidth, int srcHeight, GLuint destTexture);
 
 // returns size of the encoded data (in bytes)
-int EncodeToRamFromTexture(u32 address, GLuint source_texture, bool bFromZBuffer, bool bIsIntensityFmt, u32 copyfmt, int bScaleByHalf, const EFBRectangle& source);
+// If deferred is set, the data is only read back into deferred->pbo (which is
+// created if it doesn't exist yet), and FinishReadback() writes it to RAM later.
+int EncodeToRamFromTexture(u32 address, GLuint source_texture, bool bFromZBuffer, bool bIsIntensityFmt, u32 copyfmt, int bScaleByHalf, const EFBRectangle& source,
+                           PendingReadback* deferred = nullptr);
+void FinishReadback(PendingReadback* readback);
 
 }
 
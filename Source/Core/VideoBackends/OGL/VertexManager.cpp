@@ -2,14 +2,18 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include <fstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/FileUtil.h"
+#include "Common/Hash.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
 
+#include "VideoBackends/OGL/BoundingBox.h"
 #include "VideoBackends/OGL/main.h"
 #include "VideoBackends/OGL/ProgramShaderCache.h"
 #include "VideoBackends/OGL/Render.h"
@@ -17,6 +21,7 @@
 #include "VideoBackends/OGL/TextureCache.h"
 #include "VideoBackends/OGL/VertexManager.h"
 
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/Fifo.h"
@@ -40,6 +45,61 @@ static StreamBuffer *s_indexBuffer;
 static size_t s_baseVertex;
 static size_t s_index_offset;
 
+// Uploaded data which is still present in a stream buffer, keyed by its content hash.
+// Replayed frames send identical batches again, which can then be drawn from the
+// earlier upload.
+struct UploadedRange
+{
+	u32 size;
+	u32 stride;
+	u32 offset;
+};
+
+struct UploadCache
+{
+	u32 generation;
+	std::unordered_map<u64, UploadedRange> ranges;
+};
+
+static UploadCache s_vertex_uploads;
+static UploadCache s_index_uploads;
+static bool s_reuse_uploads;
+
+// Returns the offset of the data in the stream buffer, uploading it only if needed.
+static u32 UploadOrReuse(StreamBuffer* buffer, UploadCache& cache, const u8* data, u32 size, u32 stride, int* reused_bytes)
+{
+	if (cache.generation != buffer->GetGeneration() || cache.ranges.size() > 16384)
+	{
+		cache.ranges.clear();
+		cache.generation = buffer->GetGeneration();
+	}
+
+	u64 hash = GetHash64(data, size, 0);
+	auto it = cache.ranges.find(hash);
+	if (it != cache.ranges.end() && it->second.size == size && it->second.stride == stride)
+	{
+		*reused_bytes += size;
+		return it->second.offset;
+	}
+
+	auto mapped = buffer->Map(size, stride);
+	memcpy(mapped.first, data, size);
+	buffer->Unmap(size);
+
+	// Mapping may have wrapped around the buffer and overwritten older ranges
+	if (cache.generation != buffer->GetGeneration())
+	{
+		cache.ranges.clear();
+		cache.generation = buffer->GetGeneration();
+	}
+
+	UploadedRange& range = cache.ranges[hash];
+	range.size = size;
+	range.stride = stride;
+	range.offset = mapped.second;
+	return mapped.second;
+}
+
 VertexManager::VertexManager()
 	: m_cpu_v_buffer(MAX_VBUFFER_SIZE), m_cpu_i_buffer(MAX_IBUFFER_SIZE)
 {
@@ -73,6 +133,21 @@ void VertexManager::PrepareDrawBuffers(u32 stride)
 	u32 vertex_data_size = IndexGenerator::GetNumVerts() * stride;
 	u32 index_data_size = IndexGenerator::GetIndexLen() * sizeof(u16);
 
+	if (s_reuse_uploads)
+	{
+		int reused_vertex_bytes = 0, reused_index_bytes = 0;
+		s_baseVertex = UploadOrReuse(s_vertexBuffer, s_vertex_uploads, m_cpu_v_buffer.data(),
+			vertex_data_size, stride, &reused_vertex_bytes) / stride;
+		s_index_offset = UploadOrReuse(s_indexBuffer, s_index_uploads, (const u8*)m_cpu_i_buffer.data(),
+			index_data_size, sizeof(u16), &reused_index_bytes);
+
+		ADDSTAT(stats.thisFrame.bytesVertexStreamed, vertex_data_size - reused_vertex_bytes);
+		ADDSTAT(stats.thisFrame.bytesIndexStreamed, index_data_size - reused_index_bytes);
+		ADDSTAT(stats.thisFrame.bytesVertexReused, reused_vertex_bytes);
+		ADDSTAT(stats.thisFrame.bytesIndexReused, reused_index_bytes);
+		return;
+	}
+
 	s_vertexBuffer->Unmap(vertex_data_size);
 	s_indexBuffer->Unmap(index_data_size);
 
@@ -82,11 +157,14 @@ void VertexManager::PrepareDrawBuffers(u32 stride)
 
 void VertexManager::ResetBuffer(u32 stride)
 {
-	if (s_cull_all)
+	s_reuse_uploads = g_ActiveConfig.bReuseVertexUploads && !s_cull_all;
+
+	if (s_cull_all || s_reuse_uploads)
 	{
-		// This buffer isn't getting sent to the GPU. Just allocate it on the cpu.
+		// This buffer isn't getting sent to the GPU, or only copied to the stream
+		// buffers if it wasn't uploaded before. Just allocate it on the cpu.
 		s_pCurBufferPointer = s_pBaseBufferPointer = m_cpu_v_buffer.data();
-		s_pEndBufferPointer = s_pBaseBufferPointer + m_cpu_v_buffer.size();
+		s_pEndBufferPointer = s_pBaseBufferPointer + (s_reuse_uploads ? MAXVBUFFERSIZE : m_cpu_v_buffer.size());
 
 		IndexGenerator::Start((u16*)m_cpu_i_buffer.data());
 	}
@@ -159,13 +237,16 @@ void VertexManager::vFlush(bool useDstAlpha)
 
 	// If host supports GL_ARB_blend_func_extended, we can do dst alpha in
 	// the same pass as regular rendering.
+	// SetShader returns nullptr while the program is still being compiled in
+	// the background, in which case the draw is skipped.
+	SHADER* shader;
 	if (useDstAlpha && dualSourcePossible)
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_DUAL_SOURCE_BLEND, nativeVertexFmt->m_components, current_primitive_type);
+		shader = ProgramShaderCache::SetShader(DSTALPHA_DUAL_SOURCE_BLEND, nativeVertexFmt->m_components, current_primitive_type);
 	}
 	else
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_NONE, nativeVertexFmt->m_components, current_primitive_type);
+		shader = ProgramShaderCache::SetShader(DSTALPHA_NONE, nativeVertexFmt->m_components, current_primitive_type);
 	}
 
 	// upload global constants
@@ -174,13 +255,13 @@ void VertexManager::vFlush(bool useDstAlpha)
 	// setup the pointers
 	nativeVertexFmt->SetupVertexPointers();
 
-	Draw(stride);
+	if (shader)
+		Draw(stride);
 
 	// run through vertex groups again to set alpha
-	if (useDstAlpha && !dualSourcePossible)
+	if (useDstAlpha && !dualSourcePossible && shader &&
+		ProgramShaderCache::SetShader(DSTALPHA_ALPHA_PASS, nativeVertexFmt->m_components, current_primitive_type))
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_ALPHA_PASS, nativeVertexFmt->m_components, current_primitive_type);
-
 		// only update alpha
 		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_TRUE);
 
@@ -225,6 +306,8 @@ void VertexManager::vFlush(bool useDstAlpha)
 	g_Config.iSaveTargetId++;
 
 	ClearEFBCache();
+	if (::BoundingBox::active)
+		BoundingBox::Invalidate();
 
 	if (VertexShaderManager::m_layer_on_top)
 	{
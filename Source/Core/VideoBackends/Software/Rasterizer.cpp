@@ -3,8 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/Flag.h"
+#include "Common/Thread.h"
 #include "VideoBackends/Software/BPMemLoader.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/HwRasterizer.h"
@@ -19,6 +27,9 @@
 
 #define BLOCK_SIZE 2
 
+// Triangles covering less than this many pixels are always drawn on the calling thread
+#define THREADED_MIN_AREA (64 * 64)
+
 #define CLAMP(x, a, b) (x>b)?b:(x<a)?a:x
 
 // returns approximation of log2(f) in s28.4
@@ -49,8 +60,53 @@ static s32 scissorTop = 0;
 static s32 scissorRight = 0;
 static s32 scissorBottom = 0;
 
-static Tev tev;
-static RasterBlock rasterBlock;
+// Per-thread drawing state. The main context belongs to the thread calling
+// DrawTriangleFrontFace, worker contexts receive a copy of its Tev for every
+// triangle which is split up between threads.
+struct RasterContext
+{
+	Tev tev;
+	RasterBlock rasterBlock;
+	Tev::DeferredUpdates deferred;
+	int index;
+	int band;
+	int lastDrawnBand;
+};
+
+static RasterContext mainContext;
+
+// Half-edge functions of the triangle being drawn
+struct EdgeFunctions
+{
+	s32 C1, C2, C3;
+	s32 DX12, DX23, DX31;
+	s32 DY12, DY23, DY31;
+	s32 FDX12, FDX23, FDX31;
+	s32 FDY12, FDY23, FDY31;
+};
+
+// Large triangles are split into horizontal bands of block rows. Even bands are
+// drawn in parallel first, odd bands afterwards, so that bands drawn at the same
+// time never touch neighbouring rows. EfbInterface writes 4 bytes for each
+// 3 byte pixel, so the last pixel of a row spills into the next row.
+static struct
+{
+	EdgeFunctions edges;
+	s32 minx;
+	s32 maxx;
+	s32 miny;
+	s32 numBlockRows;
+	int numBands;
+	int phase;
+} threadedJob;
+
+// Index 0 is used by the thread calling DrawTriangleFrontFace itself
+static std::vector<std::unique_ptr<RasterContext>> threadContexts;
+static std::vector<std::thread> workerThreads;
+static std::vector<std::unique_ptr<Common::Event>> workerStartEvents;
+static Common::Event workersDoneEvent;
+static std::atomic<int> workersPending;
+static Common::Flag workersRunning;
 
 void DoState(PointerWrap &p)
 {
@@ -70,18 +126,86 @@ void DoState(PointerWrap &p)
 	p.Do(scissorTop);
 	p.Do(scissorRight);
 	p.Do(scissorBottom);
-	tev.DoState(p);
-	p.Do(rasterBlock);
+	mainContext.tev.DoState(p);
+	p.Do(mainContext.rasterBlock);
+}
+
+static void DrawBands(RasterContext& ctx);
+
+static void WorkerThread(int index)
+{
+	Common::SetCurrentThreadName("Rasterizer worker");
+
+	while (true)
+	{
+		workerStartEvents[index - 1]->Wait();
+		if (!workersRunning.IsSet())
+			return;
+
+		DrawBands(*threadContexts[index]);
+
+		if (--workersPending == 0)
+			workersDoneEvent.Set();
+	}
+}
+
+static void StartWorkers()
+{
+	u32 numThreads = g_SWVideoConfig.rasterizerThreads;
+	if (numThreads == 0)
+	{
+		// leave one core to the CPU thread
+		numThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+		numThreads = std::min(numThreads, 8u);
+	}
+
+	if (numThreads <= 1)
+		return;
+
+	workersRunning.Set();
+	for (u32 i = 0; i < numThreads; i++)
+	{
+		threadContexts.emplace_back(new RasterContext());
+		threadContexts.back()->index = i;
+	}
+	for (u32 i = 1; i < numThreads; i++)
+	{
+		workerStartEvents.emplace_back(new Common::Event());
+		workerThreads.emplace_back(WorkerThread, i);
+	}
+
+	INFO_LOG(VIDEO, "Software rasterizer using %u threads", numThreads);
+}
+
+static void StopWorkers()
+{
+	workersRunning.Clear();
+	for (auto& start_event : workerStartEvents)
+		start_event->Set();
+	for (std::thread& worker : workerThreads)
+		worker.join();
+
+	workerThreads.clear();
+	workerStartEvents.clear();
+	threadContexts.clear();
 }
 
 void Init()
 {
-	tev.Init();
+	mainContext.tev.Init();
 
 	// Set initial z reference plane in the unlikely case that zfreeze is enabled when drawing the first primitive.
 	// TODO: This is just a guess!
 	ZSlope.dfdx = ZSlope.dfdy = 0.f;
 	ZSlope.f0 = 1.f;
+
+	StopWorkers();
+	StartWorkers();
+}
+
+void Shutdown()
+{
+	StopWorkers();
 }
 
 static inline int iround(float x)
@@ -117,12 +241,18 @@ void SetScissor()
 
 void SetTevReg(int reg, int comp, bool konst, s16 color)
 {
-	tev.SetRegColor(reg, comp, konst, color);
+	mainContext.tev.SetRegColor(reg, comp, konst, color);
 }
 
-inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
+static inline void Draw(RasterContext& ctx, s32 x, s32 y, s32 xi, s32 yi)
 {
-	INCSTAT(swstats.thisFrame.rasterizedPixels);
+	Tev& tev = ctx.tev;
+	RasterBlock& rasterBlock = ctx.rasterBlock;
+
+	if (tev.Deferred)
+		tev.Deferred->rasterizedPixels++;
+	else
+		INCSTAT(swstats.thisFrame.rasterizedPixels);
 
 	float dx = vertexOffsetX + (float)(x - vertex0X);
 	float dy = vertexOffsetY + (float)(y - vertex0Y);
@@ -134,14 +264,14 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 	if (!BoundingBox::active && bpmem.UseEarlyDepthTest() && g_SWVideoConfig.bZComploc)
 	{
 		// TODO: Test if perf regs are incremented even if test is disabled
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT_ZCOMPLOC);
+		tev.IncPerfCounterQuadCount(PQ_ZCOMP_INPUT_ZCOMPLOC);
 		if (bpmem.zmode.testenable)
 		{
 			// early z
 			if (!EfbInterface::ZCompare(x, y, z))
 				return;
 		}
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
+		tev.IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
 	}
 
 	RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
@@ -184,6 +314,7 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 		tev.TextureLinear[i] = rasterBlock.TextureLinear[i];
 	}
 
+	ctx.lastDrawnBand = ctx.band;
 	tev.Draw();
 }
 
@@ -211,7 +342,7 @@ static void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, fl
 	slope->f0 = f1;
 }
 
-static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoord)
+static inline void CalculateLOD(const RasterBlock& rasterBlock, s32* lodp, bool* linear, u32 texmap, u32 texcoord)
 {
 	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
 	u8 subTexmap = texmap & 3;
@@ -224,17 +355,17 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
 	float sDelta, tDelta;
 	if (tm0.diag_lod)
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
 
 		sDelta = fabsf(uv0[0] - uv1[0]);
 		tDelta = fabsf(uv0[1] - uv1[1]);
 	}
 	else
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
-		float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
+		const float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
 
 		sDelta = std::max(fabsf(uv0[0] - uv1[0]), fabsf(uv0[0] - uv2[0]));
 		tDelta = std::max(fabsf(uv0[1] - uv1[1]), fabsf(uv0[1] - uv2[1]));
@@ -258,7 +389,7 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
 	*lodp = lod;
 }
 
-static void BuildBlock(s32 blockX, s32 blockY)
+static void BuildBlock(RasterBlock& rasterBlock, s32 blockX, s32 blockY)
 {
 	for (s32 yi = 0; yi < BLOCK_SIZE; yi++)
 	{
@@ -297,7 +428,7 @@ static void BuildBlock(s32 blockX, s32 blockY)
 		u32 texcoord = indref & 3;
 		indref >>= 3;
 
-		CalculateLOD(&rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
+		CalculateLOD(rasterBlock, &rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
 	}
 
 	for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
@@ -309,7 +440,7 @@ static void BuildBlock(s32 blockX, s32 blockY)
 			u32 texmap = order.getTexMap(stageOdd);
 			u32 texcoord = order.getTexCoord(stageOdd);
 
-			CalculateLOD(&rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
+			CalculateLOD(rasterBlock, &rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
 		}
 	}
 }
@@ -326,7 +457,197 @@ static inline void PrepareBlock(s32 blockX, s32 blockY)
 	{
 		x = blockX;
 		y = blockY;
-		BuildBlock(x, y);
+		BuildBlock(mainContext.rasterBlock, x, y);
+	}
+}
+
+// Draws all blocks of the triangle in rows [miny, maxy)
+static void DrawBlocks(RasterContext& ctx, const EdgeFunctions& edges, s32 minx, s32 maxx, s32 miny, s32 maxy)
+{
+	const s32 C1 = edges.C1, C2 = edges.C2, C3 = edges.C3;
+	const s32 DX12 = edges.DX12, DX23 = edges.DX23, DX31 = edges.DX31;
+	const s32 DY12 = edges.DY12, DY23 = edges.DY23, DY31 = edges.DY31;
+
+	// Loop through blocks
+	for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
+	{
+		for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
+		{
+			// Corners of block
+			s32 x0 = x << 4;
+			s32 x1 = (x + BLOCK_SIZE - 1) << 4;
+			s32 y0 = y << 4;
+			s32 y1 = (y + BLOCK_SIZE - 1) << 4;
+
+			// Evaluate half-space functions
+			bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
+			bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
+			bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
+			bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
+			int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
+
+			bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
+			bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
+			bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
+			bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
+			int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
+
+			bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
+			bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
+			bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
+			bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
+			int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
+
+			// Skip block when outside an edge
+			if (a == 0x0 || b == 0x0 || c == 0x0)
+				continue;
+
+			BuildBlock(ctx.rasterBlock, x, y);
+
+			// Accept whole block when totally covered
+			if (a == 0xF && b == 0xF && c == 0xF)
+			{
+				for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+				{
+					for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+					{
+						Draw(ctx, x + ix, y + iy, ix, iy);
+					}
+				}
+			}
+			else // Partially covered block
+			{
+				s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
+				s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
+				s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
+
+				for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+				{
+					s32 CX1 = CY1;
+					s32 CX2 = CY2;
+					s32 CX3 = CY3;
+
+					for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+					{
+						if (CX1 > 0 && CX2 > 0 && CX3 > 0)
+						{
+							Draw(ctx, x + ix, y + iy, ix, iy);
+						}
+
+						CX1 -= edges.FDY12;
+						CX2 -= edges.FDY23;
+						CX3 -= edges.FDY31;
+					}
+
+					CY1 += edges.FDX12;
+					CY2 += edges.FDX23;
+					CY3 += edges.FDX31;
+				}
+			}
+		}
+	}
+}
+
+// Draws the band assigned to this context in the current phase of threadedJob
+static void DrawBands(RasterContext& ctx)
+{
+	int band = 2 * ctx.index + threadedJob.phase;
+	if (band >= threadedJob.numBands)
+		return;
+
+	ctx.band = band;
+
+	s32 firstRow = threadedJob.numBlockRows * band / threadedJob.numBands;
+	s32 lastRow = threadedJob.numBlockRows * (band + 1) / threadedJob.numBands;
+	DrawBlocks(ctx, threadedJob.edges, threadedJob.minx, threadedJob.maxx,
+	           threadedJob.miny + firstRow * BLOCK_SIZE, threadedJob.miny + lastRow * BLOCK_SIZE);
+}
+
+static bool CanDrawThreaded(s32 minx, s32 maxx, s32 miny, s32 maxy)
+{
+	if (threadContexts.empty())
+		return false;
+
+	if ((maxx - minx) * (maxy - miny) < THREADED_MIN_AREA)
+		return false;
+
+	// debug dumps are written from Tev::Draw
+	if (g_SWVideoConfig.bDumpTevStages || g_SWVideoConfig.bDumpTevTextureFetches)
+		return false;
+
+	return Tev::IsPixelIndependent();
+}
+
+static void DrawTriangleThreaded(const EdgeFunctions& edges, s32 minx, s32 maxx, s32 miny, s32 maxy)
+{
+	const int numContexts = (int)threadContexts.size();
+
+	threadedJob.edges = edges;
+	threadedJob.minx = minx;
+	threadedJob.maxx = maxx;
+	threadedJob.miny = miny;
+	threadedJob.numBlockRows = (maxy - miny + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+	// An even number of bands keeps the first and the last band in different phases,
+	// the last color buffer row spills into the first depth buffer row.
+	threadedJob.numBands = std::min(2 * numContexts, (int)threadedJob.numBlockRows) & ~1;
+
+	for (auto& ctx : threadContexts)
+	{
+		// Init() rebinds the LUT pointers to the copy's own registers
+		ctx->tev = mainContext.tev;
+		ctx->tev.Init();
+		ctx->tev.Deferred = &ctx->deferred;
+
+		memset(&ctx->deferred, 0, sizeof(ctx->deferred));
+		std::copy(BoundingBox::coords, BoundingBox::coords + 4, ctx->deferred.bboxCoords);
+
+		ctx->lastDrawnBand = -1;
+	}
+
+	for (int phase = 0; phase < 2; phase++)
+	{
+		threadedJob.phase = phase;
+		workersPending = numContexts - 1;
+		for (auto& start_event : workerStartEvents)
+			start_event->Set();
+
+		DrawBands(*threadContexts[0]);
+
+		workersDoneEvent.Wait();
+	}
+
+	// Merge the side effects in, and continue with the TEV state left behind by
+	// the last pixel in drawing order, exactly like a single-threaded draw would.
+	RasterContext* last = nullptr;
+	for (auto& ctx : threadContexts)
+	{
+		const Tev::DeferredUpdates& deferred = ctx->deferred;
+
+		ADDSTAT(swstats.thisFrame.rasterizedPixels, deferred.rasterizedPixels);
+		ADDSTAT(swstats.thisFrame.tevPixelsIn, deferred.tevPixelsIn);
+		ADDSTAT(swstats.thisFrame.tevPixelsOut, deferred.tevPixelsOut);
+
+		for (int type = 0; type < PQ_NUM_MEMBERS; type++)
+		{
+			for (u32 i = 0; i < deferred.perfQuadCounts[type]; i++)
+				EfbInterface::IncPerfCounterQuadCount((PerfQueryType)type);
+		}
+
+		BoundingBox::coords[BoundingBox::LEFT] = std::min(deferred.bboxCoords[BoundingBox::LEFT], BoundingBox::coords[BoundingBox::LEFT]);
+		BoundingBox::coords[BoundingBox::RIGHT] = std::max(deferred.bboxCoords[BoundingBox::RIGHT], BoundingBox::coords[BoundingBox::RIGHT]);
+		BoundingBox::coords[BoundingBox::TOP] = std::min(deferred.bboxCoords[BoundingBox::TOP], BoundingBox::coords[BoundingBox::TOP]);
+		BoundingBox::coords[BoundingBox::BOTTOM] = std::max(deferred.bboxCoords[BoundingBox::BOTTOM], BoundingBox::coords[BoundingBox::BOTTOM]);
+
+		if (ctx->lastDrawnBand >= 0 && (!last || ctx->lastDrawnBand > last->lastDrawnBand))
+			last = ctx.get();
+	}
+
+	if (last)
+	{
+		mainContext.tev = last->tev;
+		mainContext.tev.Init();
+		mainContext.rasterBlock = last->rasterBlock;
 	}
 }
 
@@ -417,15 +738,28 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 			InitSlope(&TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
 	}
 
+	mainContext.tev.PrepareCombiners();
+
+	EdgeFunctions edges;
+
 	// Half-edge constants
-	s32 C1 = DY12 * X1 - DX12 * Y1;
-	s32 C2 = DY23 * X2 - DX23 * Y2;
-	s32 C3 = DY31 * X3 - DX31 * Y3;
+	edges.C1 = DY12 * X1 - DX12 * Y1;
+	edges.C2 = DY23 * X2 - DX23 * Y2;
+	edges.C3 = DY31 * X3 - DX31 * Y3;
 
 	// Correct for fill convention
-	if (DY12 < 0 || (DY12 == 0 && DX12 > 0)) C1++;
-	if (DY23 < 0 || (DY23 == 0 && DX23 > 0)) C2++;
-	if (DY31 < 0 || (DY31 == 0 && DX31 > 0)) C3++;
+	if (DY12 < 0 || (DY12 == 0 && DX12 > 0)) edges.C1++;
+	if (DY23 < 0 || (DY23 == 0 && DX23 > 0)) edges.C2++;
+	if (DY31 < 0 || (DY31 == 0 && DX31 > 0)) edges.C3++;
+
+	edges.DX12 = DX12; edges.DX23 = DX23; edges.DX31 = DX31;
+	edges.DY12 = DY12; edges.DY23 = DY23; edges.DY31 = DY31;
+	edges.FDX12 = FDX12; edges.FDX23 = FDX23; edges.FDX31 = FDX31;
+	edges.FDY12 = FDY12; edges.FDY23 = FDY23; edges.FDY31 = FDY31;
+
+	const s32 C1 = edges.C1;
+	const s32 C2 = edges.C2;
+	const s32 C3 = edges.C3;
 
 	// If drawing, rasterize every block
 	if (!BoundingBox::active)
@@ -434,84 +768,10 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 		minx &= ~(BLOCK_SIZE - 1);
 		miny &= ~(BLOCK_SIZE - 1);
 
-		// Loop through blocks
-		for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
-		{
-			for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
-			{
-				// Corners of block
-				s32 x0 = x << 4;
-				s32 x1 = (x + BLOCK_SIZE - 1) << 4;
-				s32 y0 = y << 4;
-				s32 y1 = (y + BLOCK_SIZE - 1) << 4;
-
-				// Evaluate half-space functions
-				bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
-				bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
-				bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
-				bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
-				int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
-
-				bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
-				bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
-				bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
-				bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
-				int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
-
-				bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
-				bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
-				bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
-				bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
-				int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
-
-				// Skip block when outside an edge
-				if (a == 0x0 || b == 0x0 || c == 0x0)
-					continue;
-
-				BuildBlock(x, y);
-
-				// Accept whole block when totally covered
-				if (a == 0xF && b == 0xF && c == 0xF)
-				{
-					for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-					{
-						for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-						{
-							Draw(x + ix, y + iy, ix, iy);
-						}
-					}
-				}
-				else // Partially covered block
-				{
-					s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
-					s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
-					s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
-
-					for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-					{
-						s32 CX1 = CY1;
-						s32 CX2 = CY2;
-						s32 CX3 = CY3;
-
-						for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-						{
-							if (CX1 > 0 && CX2 > 0 && CX3 > 0)
-							{
-								Draw(x + ix, y + iy, ix, iy);
-							}
-
-							CX1 -= FDY12;
-							CX2 -= FDY23;
-							CX3 -= FDY31;
-						}
-
-						CY1 += FDX12;
-						CY2 += FDX23;
-						CY3 += FDX31;
-					}
-				}
-			}
-		}
+		if (CanDrawThreaded(minx, maxx, miny, maxy))
+			DrawTriangleThreaded(edges, minx, maxx, miny, maxy);
+		else
+			DrawBlocks(mainContext, edges, minx, maxx, miny, maxy);
 	}
 	else
 	{
@@ -565,7 +825,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				{
 					// Build the new raster block every other pixel
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(mainContext, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (y >= BoundingBox::coords[BoundingBox::TOP])
 						break;
@@ -605,7 +865,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				if (CY1 > 0 && CY2 > 0 && CY3 > 0)
 				{
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(mainContext, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (x >= BoundingBox::coords[BoundingBox::LEFT])
 						break;
@@ -645,7 +905,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				{
 					// Build the new raster block every other pixel
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(mainContext, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (y <= BoundingBox::coords[BoundingBox::BOTTOM])
 						break;
@@ -686,7 +946,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				{
 					// Build the new raster block every other pixel
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(mainContext, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (x <= BoundingBox::coords[BoundingBox::RIGHT])
 						break;
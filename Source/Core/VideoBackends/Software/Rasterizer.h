@@ -11,6 +11,7 @@ struct OutputVertexData;
 namespace Rasterizer
 {
 	void Init();
+	void Shutdown();
 
 	void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2);
 
@@ -17,6 +17,8 @@ SWVideoConfig::SWVideoConfig()
 	bHwRasterizer = false;
 	bBypassXFB = false;
 
+	rasterizerThreads = 0;
+
 	bShowStats = false;
 
 	bDumpTextures = false;
@@ -44,6 +46,7 @@ void SWVideoConfig::Load(const char* ini_file)
 	IniFile::Section* rendering = iniFile.GetOrCreateSection("Rendering");
 	rendering->Get("HwRasterizer", &bHwRasterizer, false);
 	rendering->Get("BypassXFB", &bBypassXFB, false);
+	rendering->Get("RasterizerThreads", &rasterizerThreads, 0);
 	rendering->Get("ZComploc", &bZComploc, true);
 	rendering->Get("ZFreeze", &bZFreeze, true);
 
@@ -73,6 +76,7 @@ void SWVideoConfig::Save(const char* ini_file)
 	IniFile::Section* rendering = iniFile.GetOrCreateSection("Rendering");
 	rendering->Set("HwRasterizer", bHwRasterizer);
 	rendering->Set("BypassXFB", bBypassXFB);
+	rendering->Set("RasterizerThreads", rasterizerThreads);
 	rendering->Set("ZComploc", bZComploc);
 	rendering->Set("ZFreeze", bZFreeze);
 
@@ -23,6 +23,9 @@ struct SWVideoConfig : NonCopyable
 	bool bHwRasterizer;
 	bool bBypassXFB;
 
+	// Number of threads drawing large triangles, 0 picks one based on the CPU
+	u32 rasterizerThreads;
+
 	// Emulation features
 	bool bZComploc;
 	bool bZFreeze;
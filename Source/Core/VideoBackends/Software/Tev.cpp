@@ -6,6 +6,7 @@
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "VideoBackends/Software/DebugUtil.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/SWStatistics.h"
@@ -23,6 +24,8 @@
 
 void Tev::Init()
 {
+	Deferred = nullptr;
+
 	FixedConstants[0] = 0;
 	FixedConstants[1] = 32;
 	FixedConstants[2] = 64;
@@ -124,6 +127,52 @@ void Tev::Init()
 	m_ScaleRShiftLUT[3] = 1;
 }
 
+void Tev::PrepareCombiners()
+{
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+	{
+		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
+		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+		CombinerLanes& lanes = m_CombinerLanes[stageNum];
+
+#ifdef _M_X86
+		lanes.regular = cc.bias != 3 && ac.bias != 3;
+#else
+		lanes.regular = false;
+#endif
+		if (!lanes.regular)
+			continue;
+
+		for (int i = 0; i < 4; i++)
+		{
+			bool alpha = i == ALP_C;
+			u32 shift = alpha ? ac.shift : cc.shift;
+			u32 op = alpha ? ac.op : cc.op;
+			u32 bias = alpha ? ac.bias : cc.bias;
+			u32 clamp = alpha ? ac.clamp : cc.clamp;
+
+			lanes.shift1Mask[i] = m_ScaleLShiftLUT[shift] == 1 ? -1 : 0;
+			lanes.shift2Mask[i] = m_ScaleLShiftLUT[shift] == 2 ? -1 : 0;
+
+			// The color combiner rounds unless dividing by 2, the alpha combiner only then.
+			if ((shift == 3) == alpha)
+				lanes.round[i] = (op == 1) ? 127 : 128;
+			else
+				lanes.round[i] = 0;
+
+			// The alpha combiner negates before dividing by 256, the color combiner afterwards.
+			lanes.negateBefore[i] = (alpha && op) ? -1 : 0;
+			lanes.negateAfter[i] = (!alpha && op) ? -1 : 0;
+
+			lanes.bias[i] = m_BiasLUT[bias];
+			lanes.halveMask[i] = m_ScaleRShiftLUT[shift] ? -1 : 0;
+
+			lanes.clampMin[i] = lanes.clampMin[i + 4] = clamp ? 0 : -1024;
+			lanes.clampMax[i] = lanes.clampMax[i + 4] = clamp ? 255 : 1023;
+		}
+	}
+}
+
 static inline s16 Clamp255(s16 in)
 {
 	return in>255?255:(in<0?0:in);
@@ -186,6 +235,67 @@ void Tev::SetRasColor(int colorChan, int swaptable)
 	}
 }
 
+// Same as DrawColorRegular and DrawAlphaRegular followed by clamping,
+// with all four components computed at once.
+void Tev::DrawRegularCombiners(const CombinerLanes& lanes, TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac)
+{
+#ifdef _M_X86
+	// InputRegType truncates a, b and c to 8 bits and sign extends d from 11 bits
+	const __m128i mask8 = _mm_set1_epi32(0xff);
+	__m128i a = _mm_and_si128(_mm_setr_epi32(*m_AlphaInputLUT[ac.a], *m_ColorInputLUT[cc.a][BLU_INP],
+		*m_ColorInputLUT[cc.a][GRN_INP], *m_ColorInputLUT[cc.a][RED_INP]), mask8);
+	__m128i b = _mm_and_si128(_mm_setr_epi32(*m_AlphaInputLUT[ac.b], *m_ColorInputLUT[cc.b][BLU_INP],
+		*m_ColorInputLUT[cc.b][GRN_INP], *m_ColorInputLUT[cc.b][RED_INP]), mask8);
+	__m128i c = _mm_and_si128(_mm_setr_epi32(*m_AlphaInputLUT[ac.c], *m_ColorInputLUT[cc.c][BLU_INP],
+		*m_ColorInputLUT[cc.c][GRN_INP], *m_ColorInputLUT[cc.c][RED_INP]), mask8);
+	__m128i d = _mm_setr_epi32(*m_AlphaInputLUT[ac.d], *m_ColorInputLUT[cc.d][BLU_INP],
+		*m_ColorInputLUT[cc.d][GRN_INP], *m_ColorInputLUT[cc.d][RED_INP]);
+	d = _mm_srai_epi32(_mm_slli_epi32(d, 21), 21);
+
+	const __m128i shift1 = _mm_loadu_si128((const __m128i*)lanes.shift1Mask);
+	const __m128i shift2 = _mm_loadu_si128((const __m128i*)lanes.shift2Mask);
+	const __m128i noShift = _mm_andnot_si128(_mm_or_si128(shift1, shift2), _mm_set1_epi32(-1));
+
+	// a * (256 - c) + b * c, all factors fit in 16 bits
+	c = _mm_add_epi32(c, _mm_srli_epi32(c, 7));
+	__m128i ab = _mm_or_si128(a, _mm_slli_epi32(b, 16));
+	__m128i weights = _mm_or_si128(_mm_sub_epi32(_mm_set1_epi32(256), c), _mm_slli_epi32(c, 16));
+	__m128i temp = _mm_madd_epi16(ab, weights);
+
+	temp = _mm_or_si128(_mm_or_si128(_mm_and_si128(temp, noShift),
+		_mm_and_si128(_mm_slli_epi32(temp, 1), shift1)), _mm_and_si128(_mm_slli_epi32(temp, 2), shift2));
+	temp = _mm_add_epi32(temp, _mm_loadu_si128((const __m128i*)lanes.round));
+
+	const __m128i negateBefore = _mm_loadu_si128((const __m128i*)lanes.negateBefore);
+	const __m128i negateAfter = _mm_loadu_si128((const __m128i*)lanes.negateAfter);
+	temp = _mm_sub_epi32(_mm_xor_si128(temp, negateBefore), negateBefore);
+	temp = _mm_srai_epi32(temp, 8);
+	temp = _mm_sub_epi32(_mm_xor_si128(temp, negateAfter), negateAfter);
+
+	__m128i result = _mm_add_epi32(d, _mm_loadu_si128((const __m128i*)lanes.bias));
+	result = _mm_or_si128(_mm_or_si128(_mm_and_si128(result, noShift),
+		_mm_and_si128(_mm_slli_epi32(result, 1), shift1)), _mm_and_si128(_mm_slli_epi32(result, 2), shift2));
+	result = _mm_add_epi32(result, temp);
+
+	const __m128i halve = _mm_loadu_si128((const __m128i*)lanes.halveMask);
+	result = _mm_or_si128(_mm_andnot_si128(halve, result), _mm_and_si128(_mm_srai_epi32(result, 1), halve));
+
+	// Reg is 16 bits wide, the values are clamped after truncating them
+	result = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+	__m128i result16 = _mm_packs_epi32(result, result);
+	result16 = _mm_max_epi16(result16, _mm_loadu_si128((const __m128i*)lanes.clampMin));
+	result16 = _mm_min_epi16(result16, _mm_loadu_si128((const __m128i*)lanes.clampMax));
+
+	s16 output[8];
+	_mm_storeu_si128((__m128i*)output, result16);
+
+	Reg[cc.dest][BLU_C] = output[BLU_C];
+	Reg[cc.dest][GRN_C] = output[GRN_C];
+	Reg[cc.dest][RED_C] = output[RED_C];
+	Reg[ac.dest][ALP_C] = output[ALP_C];
+#endif
+}
+
 void Tev::DrawColorRegular(TevStageCombiner::ColorCombiner &cc, const InputRegType inputs[4])
 {
 	for (int i = 0; i < 3; i++)
@@ -504,12 +614,69 @@ void Tev::Indirect(unsigned int stageNum, s32 s, s32 t)
 	}
 }
 
+void Tev::DrawCombiners(unsigned int stageNum, bool forceScalar)
+{
+	TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
+	TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+
+	if (m_CombinerLanes[stageNum].regular && !forceScalar)
+	{
+		DrawRegularCombiners(m_CombinerLanes[stageNum], cc, ac);
+		return;
+	}
+
+	// combine inputs
+	InputRegType inputs[4];
+	for (int i = 0; i < 3; i++)
+	{
+		inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
+		inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
+		inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
+		inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
+	}
+	inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
+	inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
+	inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
+	inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
+
+	if (cc.bias != 3)
+		DrawColorRegular(cc, inputs);
+	else
+		DrawColorCompare(cc, inputs);
+
+	if (cc.clamp)
+	{
+		Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
+		Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
+		Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+	}
+	else
+	{
+		Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
+		Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
+		Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+	}
+
+	if (ac.bias != 3)
+		DrawAlphaRegular(ac, inputs);
+	else
+		DrawAlphaCompare(ac, inputs);
+
+	if (ac.clamp)
+		Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
+	else
+		Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+}
+
 void Tev::Draw()
 {
 	_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
 	_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
 
-	INCSTAT(swstats.thisFrame.tevPixelsIn);
+	if (Deferred)
+		Deferred->tevPixelsIn++;
+	else
+		INCSTAT(swstats.thisFrame.tevPixelsIn);
 
 	for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
 	{
@@ -548,7 +715,6 @@ void Tev::Draw()
 		TevKSel &kSel = bpmem.tevksel[stageNum2];
 
 		// stage combiners
-		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
 		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
 
 		int texcoordSel = order.getTexCoord(stageOdd);
@@ -589,47 +755,7 @@ void Tev::Draw()
 		// set color
 		SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
 
-		// combine inputs
-		InputRegType inputs[4];
-		for (int i = 0; i < 3; i++)
-		{
-			inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
-			inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
-			inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
-			inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
-		}
-		inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
-		inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
-		inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
-		inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
-
-		if (cc.bias != 3)
-			DrawColorRegular(cc, inputs);
-		else
-			DrawColorCompare(cc, inputs);
-
-		if (cc.clamp)
-		{
-			Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
-		}
-		else
-		{
-			Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
-		}
-
-		if (ac.bias != 3)
-			DrawAlphaRegular(ac, inputs);
-		else
-			DrawAlphaCompare(ac, inputs);
-
-		if (ac.clamp)
-			Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
-		else
-			Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+		DrawCombiners(stageNum);
 
 #if ALLOW_TEV_DUMPS
 		if (g_SWVideoConfig.bDumpTevStages)
@@ -762,20 +888,16 @@ void Tev::Draw()
 		if (late_ztest && bpmem.zmode.testenable)
 		{
 			// TODO: Check against hw if these values get incremented even if depth testing is disabled
-			EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+			IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
 
 			if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
 				return;
 
-			EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+			IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
 		}
 	}
 
-	// branchless bounding box update
-	BoundingBox::coords[BoundingBox::LEFT] = std::min((u16)Position[0], BoundingBox::coords[BoundingBox::LEFT]);
-	BoundingBox::coords[BoundingBox::RIGHT] = std::max((u16)Position[0], BoundingBox::coords[BoundingBox::RIGHT]);
-	BoundingBox::coords[BoundingBox::TOP] = std::min((u16)Position[1], BoundingBox::coords[BoundingBox::TOP]);
-	BoundingBox::coords[BoundingBox::BOTTOM] = std::max((u16)Position[1], BoundingBox::coords[BoundingBox::BOTTOM]);
+	UpdateBoundingBox();
 
 	// if we are only calculating the bounding box,
 	// there's no need to actually draw anything
@@ -803,12 +925,103 @@ void Tev::Draw()
 	}
 #endif
 
-	INCSTAT(swstats.thisFrame.tevPixelsOut);
-	EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+	if (Deferred)
+		Deferred->tevPixelsOut++;
+	else
+		INCSTAT(swstats.thisFrame.tevPixelsOut);
+	IncPerfCounterQuadCount(PQ_BLEND_INPUT);
 
 	EfbInterface::BlendTev(Position[0], Position[1], output);
 }
 
+void Tev::IncPerfCounterQuadCount(PerfQueryType type)
+{
+	if (Deferred)
+		Deferred->perfQuadCounts[type]++;
+	else
+		EfbInterface::IncPerfCounterQuadCount(type);
+}
+
+void Tev::UpdateBoundingBox()
+{
+	u16* coords = Deferred ? Deferred->bboxCoords : BoundingBox::coords;
+
+	// branchless bounding box update
+	coords[BoundingBox::LEFT] = std::min((u16)Position[0], coords[BoundingBox::LEFT]);
+	coords[BoundingBox::RIGHT] = std::max((u16)Position[0], coords[BoundingBox::RIGHT]);
+	coords[BoundingBox::TOP] = std::min((u16)Position[1], coords[BoundingBox::TOP]);
+	coords[BoundingBox::BOTTOM] = std::max((u16)Position[1], coords[BoundingBox::BOTTOM]);
+}
+
+bool Tev::IsPixelIndependent()
+{
+	// Tracks the color and alpha halves of prev, c0, c1 and c2. A register that is
+	// read before the current pixel wrote it only depends on previous pixels if
+	// some stage writes it at all; otherwise it holds a constant.
+	bool colorWritten[4] = {};
+	bool alphaWritten[4] = {};
+	bool colorReadFirst[4] = {};
+	bool alphaReadFirst[4] = {};
+	bool texWritten = false;
+	bool texReadFirst = false;
+
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+	{
+		TevStageIndirect &indirect = bpmem.tevind[stageNum];
+
+		// TexCoord is accumulated across stages, starting from the previous pixel's value
+		if (stageNum == 0 && indirect.fb_addprev)
+			return false;
+
+		// Indirect() leaves TexCoord untouched for invalid matrix selections
+		if ((indirect.mid & 3) && (indirect.mid & 12) == 12)
+			return false;
+
+		if (bpmem.tevorders[stageNum >> 1].getEnable(stageNum & 1))
+			texWritten = true;
+
+		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
+		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+
+		const u32 colorInputs[4] = { cc.a, cc.b, cc.c, cc.d };
+		for (u32 input : colorInputs)
+		{
+			if (input < 8)
+			{
+				u32 reg = input >> 1;
+				if (input & 1)
+					alphaReadFirst[reg] |= !alphaWritten[reg];
+				else
+					colorReadFirst[reg] |= !colorWritten[reg];
+			}
+			else if (input < 10)
+			{
+				texReadFirst |= !texWritten;
+			}
+		}
+
+		const u32 alphaInputs[4] = { ac.a, ac.b, ac.c, ac.d };
+		for (u32 input : alphaInputs)
+		{
+			if (input < 4)
+				alphaReadFirst[input] |= !alphaWritten[input];
+			else if (input == 4)
+				texReadFirst |= !texWritten;
+		}
+
+		colorWritten[cc.dest] = true;
+		alphaWritten[ac.dest] = true;
+	}
+
+	for (int reg = 0; reg < 4; reg++)
+	{
+		if ((colorReadFirst[reg] && colorWritten[reg]) || (alphaReadFirst[reg] && alphaWritten[reg]))
+			return false;
+	}
+
+	return !(texReadFirst && texWritten);
+}
+
 void Tev::SetRegColor(int reg, int comp, bool konst, s16 color)
 {
 	if (konst)
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "VideoBackends/Software/BPMemLoader.h"
+#include "VideoCommon/PerfQueryBase.h"
 
 class PointerWrap;
 
@@ -44,6 +45,23 @@ class Tev
 	u8 m_ScaleLShiftLUT[4];
 	u8 m_ScaleRShiftLUT[4];
 
+	// Per-lane constants for evaluating the color and alpha combiner of a stage
+	// with one set of SIMD operations. Lanes are ordered like the components of Reg.
+	struct CombinerLanes
+	{
+		bool regular; // neither combiner uses a compare mode
+		s32 shift1Mask[4];
+		s32 shift2Mask[4];
+		s32 round[4];
+		s32 negateBefore[4];
+		s32 negateAfter[4];
+		s32 bias[4];
+		s32 halveMask[4];
+		s16 clampMin[8];
+		s16 clampMax[8];
+	};
+	CombinerLanes m_CombinerLanes[16];
+
 	// enumeration for color input LUT
 	enum
 	{
@@ -66,9 +84,23 @@ class Tev
 	void DrawAlphaRegular(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
 	void DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
 
+	void DrawRegularCombiners(const CombinerLanes& lanes, TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac);
+
 	void Indirect(unsigned int stageNum, s32 s, s32 t);
 
 public:
+	// Side effects of Draw() that other pixels don't depend on. A Tev that
+	// belongs to a rasterizer worker thread collects them here, and the
+	// rasterizer merges them into the global state once the workers are done.
+	struct DeferredUpdates
+	{
+		u32 rasterizedPixels;
+		u32 tevPixelsIn;
+		u32 tevPixelsOut;
+		u32 perfQuadCounts[PQ_NUM_MEMBERS];
+		u16 bboxCoords[4];
+	};
+
 	s32 Position[3];
 	u8 Color[2][4]; // must be RGBA for correct swap table ordering
 	TextureCoordinateType Uv[8];
@@ -77,6 +109,9 @@ public:
 	s32 TextureLod[16];
 	bool TextureLinear[16];
 
+	// nullptr unless this Tev is used by a rasterizer worker thread
+	DeferredUpdates* Deferred;
+
 	enum
 	{
 		ALP_C,
@@ -87,9 +122,28 @@ public:
 
 	void Init();
 
+	// Specializes the combiners for the current TEV stage configuration,
+	// needs to be called before drawing a primitive.
+	void PrepareCombiners();
+
 	void Draw();
 
+	// Evaluates the combiners of a stage on the current register contents.
+	// forceScalar skips the SIMD path, so both can be checked against each other.
+	void DrawCombiners(unsigned int stageNum, bool forceScalar = false);
+
+	s16 GetRegColor(int reg, int comp) const { return Reg[reg][comp]; }
+
+	// Returns true if no pixel's output depends on TEV register state left
+	// behind by a previous pixel, i.e. if pixels may be drawn in any order.
+	static bool IsPixelIndependent();
+
 	void SetRegColor(int reg, int comp, bool konst, s16 color);
 
 	void DoState(PointerWrap &p);
+
+	void IncPerfCounterQuadCount(PerfQueryType type);
+
+private:
+	void UpdateBoundingBox();
 };
@@ -1,6 +1,7 @@
 #include "VideoCommon/AsyncRequests.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/TextureCacheBase.h"
 
 AsyncRequests AsyncRequests::s_singleton;
 
@@ -105,6 +106,10 @@ void AsyncRequests::HandleEvent(const AsyncRequests::Event& e)
 			g_perf_query->FlushResults();
 			break;
 
+		case Event::FLUSH_EFB_COPIES:
+			g_texture_cache->FlushAllEFBCopies();
+			break;
+
 	}
 }
 
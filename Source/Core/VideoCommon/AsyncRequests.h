@@ -25,6 +25,7 @@ public:
 			SWAP_EVENT,
 			BBOX_READ,
 			PERF_QUERY,
+			FLUSH_EFB_COPIES,
 		} type;
 		u64 time;
 
@@ -61,6 +62,10 @@ public:
 			struct
 			{
 			} perf_query;
+
+			struct
+			{
+			} flush_efb_copies;
 		};
 	};
 
@@ -20,6 +20,7 @@
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoCommon.h"
@@ -177,6 +178,8 @@ static void BPWritten(const BPCmd& bp)
 		switch (bp.newvalue & 0xFF)
 		{
 		case 0x02:
+			// The CPU may read EFB copies once it sees this
+			g_texture_cache->FlushAllEFBCopies();
 			if (!g_use_deterministic_gpu_thread)
 				PixelEngine::SetFinish(); // may generate interrupt
 			DEBUG_LOG(VIDEO, "GXSetDrawDone SetPEFinish (value: 0x%02X)", (bp.newvalue & 0xFFFF));
@@ -188,11 +191,13 @@ static void BPWritten(const BPCmd& bp)
 		}
 		return;
 	case BPMEM_PE_TOKEN_ID: // Pixel Engine Token ID
+		g_texture_cache->FlushAllEFBCopies();
 		if (!g_use_deterministic_gpu_thread)
 			PixelEngine::SetToken(static_cast<u16>(bp.newvalue & 0xFFFF), false);
 		DEBUG_LOG(VIDEO, "SetPEToken 0x%04x", (bp.newvalue & 0xFFFF));
 		return;
 	case BPMEM_PE_TOKEN_INT_ID: // Pixel Engine Interrupt Token ID
+		g_texture_cache->FlushAllEFBCopies();
 		if (!g_use_deterministic_gpu_thread)
 			PixelEngine::SetToken(static_cast<u16>(bp.newvalue & 0xFFFF), true);
 		DEBUG_LOG(VIDEO, "SetPEToken + INT 0x%04x", (bp.newvalue & 0xFFFF));
@@ -314,6 +319,7 @@ static void BPWritten(const BPCmd& bp)
 			if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bWii)
 				addr = addr & 0x01FFFFFF;
 
+			g_texture_cache->FlushEFBCopies(addr, tlutXferCount);
 			Memory::CopyFromEmu(texMem + tlutTMemAddr, addr, tlutXferCount);
 
 			return;
@@ -417,16 +423,15 @@ static void BPWritten(const BPCmd& bp)
 			u8 offset = bp.address & 2;
 			BoundingBox::active = true;
 
-			if (g_ActiveConfig.backend_info.bSupportsBBox)
+			if (g_ActiveConfig.GPUBBoxEnabled())
 			{
 				g_renderer->BBoxWrite(offset, bp.newvalue & 0x3ff);
 				g_renderer->BBoxWrite(offset + 1, bp.newvalue >> 10);
 			}
-			else
-			{
-				BoundingBox::coords[offset]     = bp.newvalue & 0x3ff;
-				BoundingBox::coords[offset + 1] = bp.newvalue >> 10;
-			}
+
+			// Also the starting point of the CPU estimate
+			BoundingBox::coords[offset]     = bp.newvalue & 0x3ff;
+			BoundingBox::coords[offset + 1] = bp.newvalue >> 10;
 		}
 		return;
 	case BPMEM_TEXINVALIDATE:
@@ -498,6 +503,8 @@ static void BPWritten(const BPCmd& bp)
 			u32 size = tmem_cfg.preload_tile_info.count * TMEM_LINE_SIZE;
 			u32 tmem_addr_even = tmem_cfg.preload_tmem_even * TMEM_LINE_SIZE;
 
+			g_texture_cache->FlushAllEFBCopies();
+
 			if (tmem_cfg.preload_tile_info.type != 3)
 			{
 				if (tmem_addr_even + size > TMEM_SIZE)
@@ -4,12 +4,22 @@
 
 
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
 #include "VideoBackends/Software/Clipper.h"
 #include "VideoBackends/Software/Rasterizer.h"
 #include "VideoBackends/Software/SetupUnit.h"
 #include "VideoBackends/Software/TransformUnit.h"
 #include "VideoCommon/BoundingBox.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/XFMemory.h"
 
 
 namespace BoundingBox
@@ -140,6 +150,96 @@ void LOADERDECL Update(VertexLoader* loader)
 	vtxUnit.SetupVertex();
 }
 
+void Estimate(const u8* vertices, int count, int primitive, const PortableVertexDeclaration& vtxDecl)
+{
+	if (!active || count == 0)
+		return;
+
+	// The scissor rectangle in EFB coordinates, right and bottom exclusive
+	const int xoff = bpmem.scissorOffset.x * 2;
+	const int yoff = bpmem.scissorOffset.y * 2;
+	const int scissor_left = std::max(bpmem.scissorTL.x - xoff, 0);
+	const int scissor_top = std::max(bpmem.scissorTL.y - yoff, 0);
+	const int scissor_right = std::min(bpmem.scissorBR.x - xoff + 1, (int)EFB_WIDTH);
+	const int scissor_bottom = std::min(bpmem.scissorBR.y - yoff + 1, (int)EFB_HEIGHT);
+	if (scissor_left >= scissor_right || scissor_top >= scissor_bottom)
+		return;
+
+	// Lines and points are wider than their vertices, sizes are in 1/6 pixels.
+	float margin = 0.0f;
+	if (primitive == GX_DRAW_POINTS)
+		margin = bpmem.lineptwidth.pointsize / 12.0f;
+	else if (primitive == GX_DRAW_LINES || primitive == GX_DRAW_LINE_STRIP)
+		margin = bpmem.lineptwidth.linesize / 12.0f;
+
+	const float* proj = xfmem.projection.rawProjection;
+	const bool perspective = xfmem.projection.type == GX_PERSPECTIVE;
+	float min_x = FLT_MAX, max_x = -FLT_MAX, min_y = FLT_MAX, max_y = -FLT_MAX;
+	bool behind_camera = false;
+
+	for (int i = 0; i < count; i++)
+	{
+		const u8* vertex = vertices + i * vtxDecl.stride;
+
+		float pos[3] = { 0.0f, 0.0f, 0.0f };
+		memcpy(pos, vertex + vtxDecl.position.offset, sizeof(float) * std::min(vtxDecl.position.components, 3));
+
+		u32 mtx_idx = g_main_cp_state.matrix_index_a.PosNormalMtxIdx;
+		if (vtxDecl.posmtx.enable)
+			mtx_idx = vertex[vtxDecl.posmtx.offset] & 0x3f;
+		const float* mtx = (const float*)&xfmem.posMatrices[mtx_idx * 4];
+
+		float view[3];
+		for (int j = 0; j < 3; j++)
+			view[j] = mtx[j * 4] * pos[0] + mtx[j * 4 + 1] * pos[1] + mtx[j * 4 + 2] * pos[2] + mtx[j * 4 + 3];
+
+		float x, y;
+		if (perspective)
+		{
+			const float w = -view[2];
+			if (!(w > 0.0f))
+			{
+				// The projection of the clipped primitive could be anywhere
+				behind_camera = true;
+				break;
+			}
+			x = (proj[0] * view[0] + proj[1] * view[2]) / w;
+			y = (proj[2] * view[1] + proj[3] * view[2]) / w;
+		}
+		else
+		{
+			x = proj[0] * view[0] + proj[1];
+			y = proj[2] * view[1] + proj[3];
+		}
+
+		x = x * xfmem.viewport.wd + xfmem.viewport.xOrig - xoff;
+		y = y * xfmem.viewport.ht + xfmem.viewport.yOrig - yoff;
+		min_x = std::min(min_x, x);
+		max_x = std::max(max_x, x);
+		min_y = std::min(min_y, y);
+		max_y = std::max(max_y, y);
+	}
+
+	int left = scissor_left, right = scissor_right, top = scissor_top, bottom = scissor_bottom;
+	if (!behind_camera)
+	{
+		// No usable positions, e.g. all of them were NaN
+		if (!(min_x <= max_x && min_y <= max_y))
+			return;
+		left = std::max(left, (int)std::floor(std::max(min_x - margin, -1.0f)));
+		right = std::min(right, (int)std::ceil(std::min(max_x + margin, (float)EFB_WIDTH + 1)));
+		top = std::max(top, (int)std::floor(std::max(min_y - margin, -1.0f)));
+		bottom = std::min(bottom, (int)std::ceil(std::min(max_y + margin, (float)EFB_HEIGHT + 1)));
+		if (left >= right || top >= bottom)
+			return;
+	}
+
+	coords[LEFT] = std::min(coords[LEFT], (u16)left);
+	coords[RIGHT] = std::max(coords[RIGHT], (u16)right);
+	coords[TOP] = std::min(coords[TOP], (u16)top);
+	coords[BOTTOM] = std::max(coords[BOTTOM], (u16)bottom);
+}
+
 // Save state
 void DoState(PointerWrap &p)
 {
@@ -35,6 +35,11 @@ void LOADERDECL SetVertexBufferPosition(VertexLoader* loader);
 void LOADERDECL Update(VertexLoader* loader);
 void Prepare(const VAT & vat, int primitive, const TVtxDesc & vtxDesc, const PortableVertexDeclaration & vtxDecl);
 
+// Widens coords to cover where the converted vertices end up in the EFB.
+// Conservative, as everything inside the scissor rectangle counts, no matter
+// whether it's culled or fails the alpha test.
+void Estimate(const u8* vertices, int count, int primitive, const PortableVertexDeclaration& vtxDecl);
+
 // Save state
 void DoState(PointerWrap &p);
 
@@ -0,0 +1,391 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonFuncs.h"
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+#include "Core/HW/Memmap.h"
+#include "VideoCommon/BoundingBox.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/DisplayListCache.h"
+#include "VideoCommon/Fifo.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VertexLoaderBase.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace DisplayListCache
+{
+
+// Smaller primitives are loaded about as fast as they are looked up.
+static const int MIN_CACHED_VERTICES = 32;
+static const size_t MAX_CACHED_BYTES = 64 * 1024 * 1024;
+static const size_t MAX_DISPLAY_LISTS = 16384;
+
+// The part of a vertex array which the vertices of a primitive index into
+struct ArrayRange
+{
+	int array;
+	u32 base;
+	u32 stride;
+	u32 offset;
+	u32 size;
+	u64 stamp;
+};
+
+struct CachedPrimitive
+{
+	VertexLoaderBase* loader;
+	int count;
+	int loaded_count; // without the skipped vertices
+	std::vector<ArrayRange> arrays;
+	std::vector<u8> vertices;
+};
+
+struct CachedDisplayList
+{
+	u32 size;
+	u64 hash;
+	u64 stamp;
+	// Only lists which are called again unmodified get their vertices cached,
+	// so lists which games rebuild every frame don't churn the cache.
+	bool reused;
+	// Keyed by the offset of the vertex data in the list
+	std::unordered_map<u32, CachedPrimitive> primitives;
+
+	std::vector<Command> commands;
+	u32 cycles;
+	bool compiled;
+	// Lists with unknown opcodes or incomplete commands are always interpreted.
+	bool uncompilable;
+};
+
+static std::unordered_map<u32, CachedDisplayList> s_display_lists;
+static size_t s_cached_bytes;
+static CachedDisplayList* s_current_list;
+static const u8* s_current_data;
+
+static void DropPrimitives(CachedDisplayList& list)
+{
+	for (const auto& entry : list.primitives)
+		s_cached_bytes -= entry.second.vertices.size();
+	list.primitives.clear();
+}
+
+static void DropAllPrimitives()
+{
+	for (auto& entry : s_display_lists)
+		entry.second.primitives.clear();
+	s_cached_bytes = 0;
+}
+
+void Shutdown()
+{
+	s_display_lists.clear();
+	s_cached_bytes = 0;
+	s_current_list = nullptr;
+	s_current_data = nullptr;
+}
+
+static bool IsEnabled()
+{
+	// The deterministic GPU thread reads display lists from copies made while
+	// preprocessing, which the write watch knows nothing about. Loaders which
+	// compute the bounding box on the CPU have to see every vertex.
+	return (g_ActiveConfig.bCacheDisplayListVertices || g_ActiveConfig.bCompileDisplayLists) &&
+	       Memory::IsWriteWatchEnabled() &&
+	       !g_use_deterministic_gpu_thread &&
+	       !(BoundingBox::active && !g_ActiveConfig.backend_info.bSupportsBBox);
+}
+
+void BeginDisplayList(u32 address, u32 size, const u8* data)
+{
+	s_current_list = nullptr;
+	if (!IsEnabled())
+	{
+		if (!s_display_lists.empty())
+			Shutdown();
+		return;
+	}
+
+	auto iter = s_display_lists.find(address);
+	if (iter != s_display_lists.end() && iter->second.size == size &&
+	    Memory::IsRangeUnmodified(address, size, iter->second.stamp))
+	{
+		iter->second.reused = true;
+	}
+	else
+	{
+		// Start watching before hashing, so writes during the hash aren't lost.
+		const u64 stamp = Memory::WatchRange(address, size);
+		if (stamp == 0)
+		{
+			if (iter != s_display_lists.end())
+			{
+				DropPrimitives(iter->second);
+				s_display_lists.erase(iter);
+			}
+			return;
+		}
+
+		if (iter == s_display_lists.end())
+		{
+			if (s_display_lists.size() >= MAX_DISPLAY_LISTS)
+				Shutdown();
+			iter = s_display_lists.emplace(address, CachedDisplayList()).first;
+			iter->second.size = 0;
+			iter->second.hash = 0;
+			iter->second.cycles = 0;
+			iter->second.compiled = false;
+			iter->second.uncompilable = false;
+		}
+
+		// Games may write the same list again, which keeps its vertices valid.
+		CachedDisplayList& list = iter->second;
+		const u64 hash = GetHash64(data, size, 0);
+		if (list.size == size && list.hash == hash)
+		{
+			list.reused = true;
+		}
+		else
+		{
+			DropPrimitives(list);
+			list.commands.clear();
+			list.size = size;
+			list.hash = hash;
+			list.reused = false;
+			list.compiled = false;
+			list.uncompilable = false;
+		}
+		list.stamp = stamp;
+	}
+
+	s_current_list = &iter->second;
+	s_current_data = data;
+}
+
+void EndDisplayList()
+{
+	s_current_list = nullptr;
+	s_current_data = nullptr;
+}
+
+const std::vector<Command>* GetCommands(u32* cycles)
+{
+	if (!s_current_list || !s_current_list->compiled || !g_ActiveConfig.bCompileDisplayLists)
+		return nullptr;
+
+	INCSTAT(stats.thisFrame.numDListsReplayed);
+	*cycles = s_current_list->cycles;
+	return &s_current_list->commands;
+}
+
+std::vector<Command>* BeginCompile()
+{
+	// Like vertices, only lists which are called again get compiled.
+	if (!s_current_list || !s_current_list->reused || s_current_list->compiled ||
+	    s_current_list->uncompilable || !g_ActiveConfig.bCompileDisplayLists)
+	{
+		return nullptr;
+	}
+
+	s_current_list->commands.clear();
+	return &s_current_list->commands;
+}
+
+void EndCompile(bool success, u32 cycles)
+{
+	CachedDisplayList& list = *s_current_list;
+	list.compiled = success;
+	list.uncompilable = !success;
+	list.cycles = cycles;
+	if (!success)
+		list.commands.clear();
+}
+
+void DropCommands()
+{
+	s_current_list->compiled = false;
+	s_current_list->commands.clear();
+}
+
+// Finds the index ranges of all indexed attributes of the vertices at src and
+// starts watching the array memory they cover. Returns false if a range can't
+// be watched, or if the vertex size doesn't match the loader's.
+static bool WatchArrays(const TVtxDesc& desc, const VAT& vat, int vertex_size, const u8* src, int count, std::vector<ArrayRange>* ranges)
+{
+	struct Attribute
+	{
+		u64 type;
+		int array;
+		u32 size; // of one element in the array, or of the direct data
+		int num_indices;
+		u32 min_index;
+		u32 max_index;
+	};
+
+	static const u32 color_sizes[8] = { 2, 3, 4, 2, 3, 4, 4, 4 };
+	const u64 tc[8] = {
+		desc.Tex0Coord, desc.Tex1Coord, desc.Tex2Coord, desc.Tex3Coord,
+		desc.Tex4Coord, desc.Tex5Coord, desc.Tex6Coord, desc.Tex7Coord,
+	};
+	const u32 tc_elements[8] = {
+		vat.g0.Tex0CoordElements, vat.g1.Tex1CoordElements, vat.g1.Tex2CoordElements, vat.g1.Tex3CoordElements,
+		vat.g1.Tex4CoordElements, vat.g2.Tex5CoordElements, vat.g2.Tex6CoordElements, vat.g2.Tex7CoordElements,
+	};
+	const u32 tc_formats[8] = {
+		vat.g0.Tex0CoordFormat, vat.g1.Tex1CoordFormat, vat.g1.Tex2CoordFormat, vat.g1.Tex3CoordFormat,
+		vat.g1.Tex4CoordFormat, vat.g2.Tex5CoordFormat, vat.g2.Tex6CoordFormat, vat.g2.Tex7CoordFormat,
+	};
+
+	// In the order they appear in a vertex, after the matrix indices
+	Attribute attributes[12];
+	int num_attributes = 0;
+	auto add = [&](u64 type, int array, u32 size, int num_indices)
+	{
+		if (type == NOT_PRESENT)
+			return;
+		Attribute attribute = { type, array, size, num_indices, 0xFFFF, 0 };
+		attributes[num_attributes++] = attribute;
+	};
+	add(desc.Position, ARRAY_POSITION, (vat.g0.PosElements ? 3 : 2) << (vat.g0.PosFormat / 2), 1);
+	add(desc.Normal, ARRAY_NORMAL, (vat.g0.NormalElements ? 9 : 3) << (vat.g0.NormalFormat / 2),
+	    vat.g0.NormalElements && vat.g0.NormalIndex3 ? 3 : 1);
+	add(desc.Color0, ARRAY_COLOR, color_sizes[vat.g0.Color0Comp], 1);
+	add(desc.Color1, ARRAY_COLOR2, color_sizes[vat.g0.Color1Comp], 1);
+	for (int i = 0; i < 8; i++)
+		add(tc[i], ARRAY_TEXCOORD0 + i, (tc_elements[i] ? 2 : 1) << (tc_formats[i] / 2), 1);
+
+	int size = 0;
+	for (int i = 0; i < 9; i++)
+		size += (desc.Hex >> i) & 1;
+	const int matrix_indices_size = size;
+	for (int i = 0; i < num_attributes; i++)
+	{
+		const Attribute& a = attributes[i];
+		if (a.type == DIRECT)
+			size += a.size;
+		else
+			size += a.num_indices * (a.type == INDEX8 ? 1 : 2);
+	}
+	if (size != vertex_size)
+		return false;
+
+	for (int v = 0; v < count; v++)
+	{
+		const u8* data = src + v * vertex_size + matrix_indices_size;
+		for (int i = 0; i < num_attributes; i++)
+		{
+			Attribute& a = attributes[i];
+			if (a.type == DIRECT)
+			{
+				data += a.size;
+				continue;
+			}
+
+			// Vertices with a position index of all ones are skipped, so
+			// nothing else of them is read. Position is always the first attribute.
+			if (a.array == ARRAY_POSITION)
+			{
+				u32 index = a.type == INDEX8 ? *data : Common::swap16(data);
+				if (index == (a.type == INDEX8 ? 0xFFu : 0xFFFFu))
+					break;
+			}
+
+			for (int j = 0; j < a.num_indices; j++)
+			{
+				u32 index = a.type == INDEX8 ? *data : Common::swap16(data);
+				data += a.type == INDEX8 ? 1 : 2;
+				a.min_index = std::min(a.min_index, index);
+				a.max_index = std::max(a.max_index, index);
+			}
+		}
+	}
+
+	ranges->clear();
+	for (int i = 0; i < num_attributes; i++)
+	{
+		const Attribute& a = attributes[i];
+		if (a.type == DIRECT || a.min_index > a.max_index)
+			continue;
+
+		ArrayRange range;
+		range.array = a.array;
+		range.base = g_main_cp_state.array_bases[a.array];
+		range.stride = g_main_cp_state.array_strides[a.array];
+		range.offset = a.min_index * range.stride;
+		range.size = (a.max_index - a.min_index) * range.stride + a.size;
+		range.stamp = Memory::WatchRange(range.base + range.offset, range.size);
+		if (range.stamp == 0)
+			return false;
+		ranges->push_back(range);
+	}
+	return true;
+}
+
+static bool AreArraysUnmodified(const CachedPrimitive& primitive)
+{
+	for (const ArrayRange& range : primitive.arrays)
+	{
+		if (g_main_cp_state.array_bases[range.array] != range.base ||
+		    g_main_cp_state.array_strides[range.array] != range.stride ||
+		    !Memory::IsRangeUnmodified(range.base + range.offset, range.size, range.stamp))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int RunVertices(VertexLoaderBase* loader, int vtx_attr_group, DataReader src, DataReader dst, int count, int primitive)
+{
+	if (!s_current_list || count < MIN_CACHED_VERTICES || !g_ActiveConfig.bCacheDisplayListVertices)
+		return loader->RunVertices(src, dst, count, primitive);
+
+	CachedDisplayList& list = *s_current_list;
+	const u32 offset = (u32)(src.GetPointer() - s_current_data);
+	auto iter = list.primitives.find(offset);
+	if (iter != list.primitives.end())
+	{
+		const CachedPrimitive& cached = iter->second;
+		if (cached.loader == loader && cached.count == count && AreArraysUnmodified(cached))
+		{
+			memcpy(dst.GetPointer(), cached.vertices.data(), cached.vertices.size());
+			loader->m_numLoadedVertices += count;
+			ADDSTAT(stats.thisFrame.numCachedVertices, count);
+			return cached.loaded_count;
+		}
+
+		s_cached_bytes -= cached.vertices.size();
+		list.primitives.erase(iter);
+	}
+
+	// Watch the arrays before the loader reads them.
+	std::vector<ArrayRange> arrays;
+	if (!list.reused || !WatchArrays(g_main_cp_state.vtx_desc, g_main_cp_state.vtx_attr[vtx_attr_group],
+	                                 loader->m_VertexSize, src.GetPointer(), count, &arrays))
+	{
+		return loader->RunVertices(src, dst, count, primitive);
+	}
+
+	const int loaded_count = loader->RunVertices(src, dst, count, primitive);
+	const size_t size = loaded_count * loader->m_native_vtx_decl.stride;
+	if (s_cached_bytes + size > MAX_CACHED_BYTES)
+		DropAllPrimitives();
+
+	CachedPrimitive& cached = list.primitives[offset];
+	cached.loader = loader;
+	cached.count = count;
+	cached.loaded_count = loaded_count;
+	cached.arrays.swap(arrays);
+	cached.vertices.assign(dst.GetPointer(), dst.GetPointer() + size);
+	s_cached_bytes += size;
+	return loaded_count;
+}
+
+}
@@ -0,0 +1,51 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/DataReader.h"
+
+class VertexLoaderBase;
+
+// Keeps what was derived from display lists which games call over and over:
+// the commands found by the opcode decoder, so a list can be replayed without
+// parsing it again, and the converted vertices of its primitives, so that
+// static geometry only goes through the vertex loader once. Both are used as
+// long as neither the display list nor the parts of the vertex arrays it
+// indexes were written to since, which is tracked with Memory's write watching.
+namespace DisplayListCache
+{
+	// A command of a display list which has an effect when it is replayed
+	struct Command
+	{
+		u8 cmd_byte;
+		u32 offset; // of the opcode in the list
+		u32 size;   // including the opcode
+	};
+
+	void Shutdown();
+
+	// Called by the opcode decoder around interpreting a display list
+	void BeginDisplayList(u32 address, u32 size, const u8* data);
+	void EndDisplayList();
+
+	// Returns the commands of the current display list and the cycles it takes,
+	// or null if it hasn't been compiled.
+	const std::vector<Command>* GetCommands(u32* cycles);
+	// Returns where the opcode decoder should record the commands of the
+	// current display list while interpreting it, or null if it shouldn't.
+	std::vector<Command>* BeginCompile();
+	void EndCompile(bool success, u32 cycles);
+	// Forgets the commands of the current display list, e.g. because a
+	// primitive's size doesn't match anymore. The list is compiled again later.
+	void DropCommands();
+
+	// Runs the loader on the vertices at src, or copies them from the cache if
+	// they are part of a display list which was converted before. Returns the
+	// number of vertices written to dst, like VertexLoaderBase::RunVertices.
+	int RunVertices(VertexLoaderBase* loader, int vtx_attr_group, DataReader src, DataReader dst, int count, int primitive);
+}
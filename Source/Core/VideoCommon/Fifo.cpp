@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Common/Atomic.h"
 #include "Common/ChunkFile.h"
 #include "Common/CPUDetect.h"
@@ -9,6 +11,8 @@
 #include "Common/FPURoundMode.h"
 #include "Common/MemoryUtil.h"
 #include "Common/Thread.h"
+#include "Common/Timer.h"
+#include "Common/Logging/Log.h"
 
 #include "Core/ARBruteForcer.h"
 #include "Core/ConfigManager.h"
@@ -24,6 +28,7 @@
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PixelEngine.h"
+#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/VR.h"
@@ -45,9 +50,17 @@ static std::mutex s_video_buffer_lock;
 static std::condition_variable s_video_buffer_cond;
 static u8* s_video_buffer;
 static u8* s_video_buffer_read_ptr;
-static std::atomic<u8*> s_video_buffer_write_ptr;
-static std::atomic<u8*> s_video_buffer_seen_ptr;
-static u8* s_video_buffer_pp_read_ptr;
+// The pointers written by the CPU thread and the ones written by the GPU
+// thread are on separate cache lines, so that polling one side doesn't keep
+// stealing the line the other side is writing to.
+static std::atomic<u8*> GC_ALIGNED64(s_video_buffer_write_ptr);
+static std::atomic<u8*> GC_ALIGNED64(s_video_buffer_seen_ptr);
+static u8* GC_ALIGNED64(s_video_buffer_pp_read_ptr);
+// How much data the command at pp_read_ptr needs before it is worth parsing again
+static size_t s_video_buffer_pp_needed;
+// Set while SyncGPU sleeps on s_video_buffer_cond, so that the GPU thread
+// only has to take the lock when somebody is waiting.
+static std::atomic<bool> s_video_buffer_sync_waiting;
 // The read_ptr is always owned by the GPU thread.  In normal mode, so is the
 // write_ptr, despite it being atomic.  In g_use_deterministic_gpu_thread mode,
 // things get a bit more complicated:
@@ -58,7 +71,10 @@ static u8* s_video_buffer_pp_read_ptr;
 // - The write_ptr is written by the CPU thread after it copies data from the
 // FIFO.  Maybe someday it will be under the lock.  For now, because RunGpuLoop
 // polls, it's just atomic.
+// - SyncGPU spins on the seen_ptr for a bit before it sleeps on the cond.
 // - The pp_read_ptr is the CPU preprocessing version of the read_ptr.
+// Large vertex commands arrive over many bursts, so the preprocessor waits
+// for pp_needed bytes instead of parsing the command again after each one.
 
 static Common::Flag s_gpu_is_running; // If this one is set, the gpu loop will be called at least once again
 static Common::Event s_gpu_new_work_event;
@@ -66,6 +82,22 @@ static Common::Event s_gpu_new_work_event;
 static Common::Flag s_gpu_is_pending; // If this one is set, there might still be work to do
 static Common::Event s_gpu_done_event;
 
+// The GPU thread spins for a while before it parks on s_gpu_new_work_event,
+// since a wakeup through the kernel usually takes longer than the CPU thread
+// needs for the next batch. The spin gets longer when it pays off and shorter
+// when it doesn't.
+static const u32 GPU_SPIN_MIN = 16;
+static const u32 GPU_SPIN_MAX = 4096;
+static u32 s_gpu_spin_count = 256;
+static const u32 SYNC_GPU_SPIN_COUNT = 256;
+
+// Latency of the CPU -> GPU wake path
+static std::atomic<u64> s_gpu_wake_time;
+static u64 s_gpu_wakeups;
+static u64 s_gpu_wakeups_parked;
+static u64 s_gpu_wake_latency_total;
+static u64 s_gpu_wake_latency_max;
+
 void Fifo_DoState(PointerWrap &p)
 {
 	if (!s_video_buffer && ARBruteForcer::ch_bruteforce)
@@ -79,6 +111,7 @@ void Fifo_DoState(PointerWrap &p)
 	{
 		// We're good and paused, right?
 		s_video_buffer_seen_ptr = s_video_buffer_pp_read_ptr = s_video_buffer_read_ptr;
+		s_video_buffer_pp_needed = 0;
 	}
 	p.Do(g_bSkipCurrentFrame);
 }
@@ -88,6 +121,7 @@ void Fifo_PauseAndLock(bool doLock, bool unpauseOnUnlock)
 	if (doLock)
 	{
 		SyncGPU(SYNC_GPU_OTHER);
+		FlushEFBCopiesToRam();
 		EmulatorState(false);
 		FlushGpu();
 	}
@@ -151,11 +185,16 @@ void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
 {
 	if (g_use_deterministic_gpu_thread)
 	{
-		std::unique_lock<std::mutex> lk(s_video_buffer_lock);
 		u8* write_ptr = s_video_buffer_write_ptr;
+		for (u32 i = 0; i < SYNC_GPU_SPIN_COUNT && GpuRunningState && s_video_buffer_seen_ptr != write_ptr; i++)
+			Common::YieldCPU();
+
+		std::unique_lock<std::mutex> lk(s_video_buffer_lock);
+		s_video_buffer_sync_waiting = true;
 		s_video_buffer_cond.wait(lk, [&]() {
 			return !GpuRunningState || s_video_buffer_seen_ptr == write_ptr;
 		});
+		s_video_buffer_sync_waiting = false;
 		if (!GpuRunningState)
 			return;
 
@@ -264,7 +303,12 @@ static void ReadDataFromFifoOnCPU(u32 readPtr)
 		}
 	}
 	Memory::CopyFromEmu(s_video_buffer_write_ptr, readPtr, len);
-	s_video_buffer_pp_read_ptr = OpcodeDecoder_Run<true>(DataReader(s_video_buffer_pp_read_ptr, write_ptr + len), nullptr, false);
+	if ((size_t)(write_ptr + len - s_video_buffer_pp_read_ptr) >= s_video_buffer_pp_needed)
+	{
+		u32 needed;
+		s_video_buffer_pp_read_ptr = OpcodeDecoder_Run<true>(DataReader(s_video_buffer_pp_read_ptr, write_ptr + len), nullptr, false, false, &needed);
+		s_video_buffer_pp_needed = needed;
+	}
 
 #ifdef INLINE_OPCODE
 	//Render Extra Headtracking Frames for VR.
@@ -285,11 +329,53 @@ void ResetVideoBuffer()
 	s_video_buffer_write_ptr = s_video_buffer;
 	s_video_buffer_seen_ptr = s_video_buffer;
 	s_video_buffer_pp_read_ptr = s_video_buffer;
+	s_video_buffer_pp_needed = 0;
 	s_fifo_aux_write_ptr = s_fifo_aux_data;
 	s_fifo_aux_read_ptr = s_fifo_aux_data;
 }
 
 
+static void WaitForGpuWork()
+{
+	bool parked = true;
+	for (u32 i = 0; i < s_gpu_spin_count; i++)
+	{
+		if (s_gpu_is_running.IsSet() || !GpuRunningState)
+		{
+			parked = false;
+			break;
+		}
+		Common::YieldCPU();
+	}
+
+	if (parked)
+	{
+		s_gpu_spin_count = std::max(s_gpu_spin_count / 2, GPU_SPIN_MIN);
+		if (!s_gpu_new_work_event.WaitFor(std::chrono::milliseconds(100)))
+			return;
+	}
+	else
+	{
+		s_gpu_spin_count = std::min(s_gpu_spin_count * 2, GPU_SPIN_MAX);
+	}
+
+	u64 wake_time = s_gpu_wake_time.exchange(0);
+	if (!wake_time)
+		return;
+
+	u64 latency = Common::Timer::GetTimeUs() - wake_time;
+	s_gpu_wakeups++;
+	s_gpu_wake_latency_total += latency;
+	s_gpu_wake_latency_max = std::max(s_gpu_wake_latency_max, latency);
+	INCSTAT(stats.thisFrame.numGpuWakeups);
+	ADDSTAT(stats.thisFrame.gpuWakeLatency, (int)latency);
+	if (parked)
+	{
+		s_gpu_wakeups_parked++;
+		INCSTAT(stats.thisFrame.numGpuWakeupsParked);
+	}
+}
+
 // Description: Main FIFO update loop
 // Purpose: Keep the Core HW updated about the CPU-GPU distance
 void RunGpuLoop()
@@ -298,6 +384,12 @@ void RunGpuLoop()
 	SCPFifoStruct &fifo = CommandProcessor::fifo;
 	u32 cyclesExecuted = 0;
 
+	s_gpu_wake_time = 0;
+	s_gpu_wakeups = 0;
+	s_gpu_wakeups_parked = 0;
+	s_gpu_wake_latency_total = 0;
+	s_gpu_wake_latency_max = 0;
+
 	AsyncRequests::GetInstance()->SetEnable(true);
 	AsyncRequests::GetInstance()->SetPassthrough(false);
 
@@ -326,9 +418,10 @@ void RunGpuLoop()
 				g_new_frame_just_rendered = false;
 #endif
 
+				s_video_buffer_seen_ptr = write_ptr;
+				if (s_video_buffer_sync_waiting)
 				{
 					std::lock_guard<std::mutex> vblk(s_video_buffer_lock);
-					s_video_buffer_seen_ptr = write_ptr;
 					s_video_buffer_cond.notify_all();
 				}
 			}
@@ -417,11 +510,18 @@ void RunGpuLoop()
 		}
 		else
 		{
-			s_gpu_new_work_event.WaitFor(std::chrono::milliseconds(100));
+			WaitForGpuWork();
 		}
 	}
 	// wake up SyncGPU if we were interrupted
 	s_video_buffer_cond.notify_all();
+
+	if (s_gpu_wakeups)
+	{
+		INFO_LOG(VIDEO, "GPU thread woken up %llu times (%llu parked), latency %llu us average, %llu us max",
+		         (unsigned long long)s_gpu_wakeups, (unsigned long long)s_gpu_wakeups_parked,
+		         (unsigned long long)(s_gpu_wake_latency_total / s_gpu_wakeups), (unsigned long long)s_gpu_wake_latency_max);
+	}
 	AsyncRequests::GetInstance()->SetEnable(false);
 	AsyncRequests::GetInstance()->SetPassthrough(true);
 }
@@ -438,6 +538,23 @@ void FlushGpu()
 	}
 }
 
+void FlushEFBCopiesToRam()
+{
+	// The GPU thread only handles events while the emulator is running. If it
+	// isn't, the copies were already written out when it was paused.
+	if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bCPUThread || g_use_deterministic_gpu_thread ||
+	    !GpuRunningState || !EmuRunningState)
+		return;
+
+	// Let the GPU thread make the copies still in the FIFO first
+	FlushGpu();
+
+	AsyncRequests::Event e;
+	e.type = AsyncRequests::Event::FLUSH_EFB_COPIES;
+	e.time = 0;
+	AsyncRequests::GetInstance()->PushEvent(e, true);
+}
+
 bool AtBreakpoint()
 {
 	SCPFifoStruct &fifo = CommandProcessor::fifo;
@@ -499,6 +616,7 @@ void RunGpu()
 	// wake up GPU thread
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bCPUThread && !s_gpu_is_running.IsSet())
 	{
+		s_gpu_wake_time = Common::Timer::GetTimeUs();
 		s_gpu_is_pending.Set();
 		s_gpu_is_running.Set();
 		s_gpu_new_work_event.Set();
@@ -541,6 +659,7 @@ void Fifo_UpdateWantDeterminism(bool want)
 		{
 			// These haven't been updated in non-deterministic mode.
 			s_video_buffer_seen_ptr = s_video_buffer_pp_read_ptr = s_video_buffer_read_ptr;
+			s_video_buffer_pp_needed = 0;
 			CopyPreprocessCPStateFromMain();
 			VertexLoaderManager::MarkAllDirty();
 		}
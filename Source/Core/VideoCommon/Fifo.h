@@ -42,6 +42,8 @@ void PushFifoAuxBuffer(void* ptr, size_t size);
 void* PopFifoAuxBuffer(size_t size);
 
 void FlushGpu();
+// Makes the GPU thread write EFB copies it deferred to RAM, e.g. before a savestate.
+void FlushEFBCopiesToRam();
 void RunGpu();
 void RunGpuLoop();
 void ExitGpuLoop();
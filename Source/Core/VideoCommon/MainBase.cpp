@@ -31,6 +31,8 @@ static volatile struct
 
 void VideoBackendHardware::EmuStateChange(EMUSTATE_CHANGE newState)
 {
+	if (newState == EMUSTATE_CHANGE_PAUSE)
+		FlushEFBCopiesToRam();
 	EmulatorState((newState == EMUSTATE_CHANGE_PLAY) ? true : false);
 }
 
@@ -149,7 +151,8 @@ u32 VideoBackendHardware::Video_GetQueryResult(PerfQueryType type)
 	e.time = 0;
 	e.type = AsyncRequests::Event::PERF_QUERY;
 
-	if (!g_perf_query->IsFlushed())
+	// With PerfQueryLatency, the last complete results are returned instead of waiting
+	if (!g_perf_query->IsFlushed() && g_ActiveConfig.iPerfQueryLatency <= 0)
 		AsyncRequests::GetInstance()->PushEvent(e, true);
 
 	return g_perf_query->GetQueryResult(type);
@@ -162,6 +165,9 @@ u16 VideoBackendHardware::Video_GetBoundingBox(int index)
 
 	SyncGPU(SYNC_GPU_BBOX);
 
+	if (g_ActiveConfig.iBBoxMode == BBOX_ESTIMATE)
+		return BoundingBox::coords[index];
+
 	AsyncRequests::Event e;
 	u16 result;
 	e.time = 0;
@@ -218,6 +224,8 @@ void VideoBackendHardware::CheckInvalidState()
 	{
 		m_invalid = false;
 
+		// Copies made before the state was loaded must not overwrite the loaded RAM
+		g_texture_cache->DiscardEFBCopies();
 		BPReload();
 		TextureCache::Invalidate();
 	}
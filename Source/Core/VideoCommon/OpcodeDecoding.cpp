@@ -24,6 +24,7 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/DisplayListCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PixelEngine.h"
@@ -38,6 +39,114 @@
 bool g_bRecordFifoData = false;
 static bool s_bFifoErrorSeen = false;
 
+// Where the commands of the display list which is being compiled go
+static std::vector<DisplayListCache::Command>* s_dl_commands = nullptr;
+static const u8* s_dl_start = nullptr;
+static bool s_dl_compile_failed = false;
+
+static void RecordDisplayListCommand(u8 cmd_byte, const u8* start, const u8* end)
+{
+	switch (cmd_byte)
+	{
+	case GX_NOP:
+	case GX_UNKNOWN_RESET:
+	case GX_CMD_CALL_DL:
+	case GX_CMD_UNKNOWN_METRICS:
+	case GX_CMD_INVL_VC:
+		// Nothing to do but count cycles, which the list's total already covers
+		break;
+
+	case GX_LOAD_CP_REG:
+	case GX_LOAD_XF_REG:
+	case GX_LOAD_INDX_A:
+	case GX_LOAD_INDX_B:
+	case GX_LOAD_INDX_C:
+	case GX_LOAD_INDX_D:
+	case GX_LOAD_BP_REG:
+		s_dl_commands->push_back({ cmd_byte, u32(start - s_dl_start), u32(end - start) });
+		break;
+
+	default:
+		if ((cmd_byte & 0xC0) == 0x80)
+			s_dl_commands->push_back({ cmd_byte, u32(start - s_dl_start), u32(end - start) });
+		else
+			s_dl_compile_failed = true;
+		break;
+	}
+}
+
+// Executes the commands of a compiled display list without decoding its opcodes.
+// Returns how far into the list it got, which is less than size if the vertex
+// format changed so that a primitive's size doesn't match anymore.
+static u32 ReplayDisplayList(u8* data, u32 size, const std::vector<DisplayListCache::Command>& commands, u32* cycles)
+{
+	for (const DisplayListCache::Command& command : commands)
+	{
+		DataReader src(data + command.offset + 1, data + size);
+		switch (command.cmd_byte)
+		{
+		case GX_LOAD_CP_REG:
+			{
+				*cycles += 12;
+				u8 sub_cmd = src.Read<u8>();
+				u32 value = src.Read<u32>();
+				LoadCPReg(sub_cmd, value);
+				INCSTAT(stats.thisFrame.numCPLoads);
+			}
+			break;
+
+		case GX_LOAD_XF_REG:
+			{
+				u32 Cmd2 = src.Read<u32>();
+				int transfer_size = ((Cmd2 >> 16) & 15) + 1;
+				*cycles += 18 + 6 * transfer_size;
+				LoadXFReg(transfer_size, Cmd2 & 0xFFFF, src);
+				INCSTAT(stats.thisFrame.numXFLoads);
+			}
+			break;
+
+		case GX_LOAD_INDX_A:
+		case GX_LOAD_INDX_B:
+		case GX_LOAD_INDX_C:
+		case GX_LOAD_INDX_D:
+			*cycles += 6;
+			LoadIndexedXF(src.Read<u32>(), 0xC + ((command.cmd_byte - GX_LOAD_INDX_A) >> 3));
+			break;
+
+		case GX_LOAD_BP_REG:
+			*cycles += 12;
+			LoadBPReg(src.Read<u32>());
+			INCSTAT(stats.thisFrame.numBPLoads);
+			break;
+
+		default:
+			{
+				u16 num_vertices = src.Read<u16>();
+				int bytes = VertexLoaderManager::RunVertices(
+					command.cmd_byte & GX_VAT_MASK,
+					(command.cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT,
+					num_vertices,
+					src,
+					g_bSkipCurrentFrame,
+					false);
+
+				if (bytes != (int)command.size - 3)
+				{
+					// Nothing was loaded if the vertices didn't fit, so decode the
+					// primitive again. Otherwise continue right after it.
+					u32 offset = bytes < 0 ? command.offset : command.offset + 3 + bytes;
+					DisplayListCache::DropCommands();
+					return offset;
+				}
+
+				*cycles += num_vertices * 4 * 3 + 6;
+			}
+			break;
+		}
+	}
+	return size;
+}
+
 static u32 InterpretDisplayList(u32 address, u32 size)
 {
 	u8* startAddress;
@@ -55,7 +164,42 @@ static u32 InterpretDisplayList(u32 address, u32 size)
 		// temporarily swap dl and non-dl (small "hack" for the stats)
 		Statistics::SwapDL();
 
-		OpcodeDecoder_Run(DataReader(startAddress, startAddress + size), &cycles, true, true);
+		DisplayListCache::BeginDisplayList(address, size, startAddress);
+
+		// Lists have to be decoded while recording, so they end up in the FIFO log.
+		u32 offset = 0;
+		u32 list_cycles;
+		const std::vector<DisplayListCache::Command>* commands = nullptr;
+		if (!g_bRecordFifoData)
+			commands = DisplayListCache::GetCommands(&list_cycles);
+		if (commands)
+		{
+			offset = ReplayDisplayList(startAddress, size, *commands, &cycles);
+			if (offset == size)
+				cycles = list_cycles;
+		}
+
+		if (offset < size)
+		{
+			if (!commands)
+			{
+				s_dl_commands = DisplayListCache::BeginCompile();
+				s_dl_start = startAddress;
+				s_dl_compile_failed = false;
+			}
+
+			u32 remaining_cycles = 0;
+			u8* end = OpcodeDecoder_Run(DataReader(startAddress + offset, startAddress + size), &remaining_cycles, true, true);
+			cycles += remaining_cycles;
+
+			if (s_dl_commands)
+			{
+				DisplayListCache::EndCompile(!s_dl_compile_failed && end == startAddress + size, cycles);
+				s_dl_commands = nullptr;
+			}
+		}
+
+		DisplayListCache::EndDisplayList();
 		INCSTAT(stats.thisFrame.numDListsCalled);
 
 		// un-swap
@@ -159,11 +303,14 @@ void OpcodeDecoder_Shutdown()
 }
 
 template <bool is_preprocess>
-u8* OpcodeDecoder_Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
+u8* OpcodeDecoder_Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call, u32* incomplete_size)
 {
 	u32 totalCycles = 0;
 	u8* opcodeStart;
 
+	if (incomplete_size)
+		*incomplete_size = 0;
+
 	//if (((u32)(src.buffer) >= 0x92700000) && ((u32)(src.buffer) <= 0x9281FFFF))
 	//if (((u32)(src.buffer) == 0x9281F7AD)) //Doesn't work?
 	//if (((u32)(src.end) == 0x92e4d640))
@@ -352,7 +499,12 @@ u8* OpcodeDecoder_Run(DataReader src, u32* cycles, bool in_display_list, bool re
 					is_preprocess);
 
 				if (bytes < 0)
+				{
+					// Opcode, vertex count and vertices
+					if (incomplete_size)
+						*incomplete_size = 3 - bytes;
 					goto end;
+				}
 
 				src.Skip(bytes);
 
@@ -372,6 +524,9 @@ u8* OpcodeDecoder_Run(DataReader src, u32* cycles, bool in_display_list, bool re
 			break;
 		}
 
+		if (!is_preprocess && s_dl_commands)
+			RecordDisplayListCommand(cmd_byte, opcodeStart, src.GetPointer());
+
 		// Display lists get added directly into the FIFO stream
 		if (!is_preprocess && g_bRecordFifoData && cmd_byte != GX_CMD_CALL_DL)
 		{
@@ -389,5 +544,5 @@ end:
 	return opcodeStart;
 }
 
-template u8* OpcodeDecoder_Run<true>(DataReader src, u32* cycles, bool in_display_list, bool recursive_call = false);
-template u8* OpcodeDecoder_Run<false>(DataReader src, u32* cycles, bool in_display_list, bool recursive_call = false);
+template u8* OpcodeDecoder_Run<true>(DataReader src, u32* cycles, bool in_display_list, bool recursive_call = false, u32* incomplete_size = nullptr);
+template u8* OpcodeDecoder_Run<false>(DataReader src, u32* cycles, bool in_display_list, bool recursive_call = false, u32* incomplete_size = nullptr);
@@ -43,5 +43,7 @@ extern bool g_bRecordFifoData;
 void OpcodeDecoder_Init();
 void OpcodeDecoder_Shutdown();
 
+// If incomplete_size is given, it receives the size of the incomplete command
+// decoding stopped at, or 0 if that isn't known.
 template <bool is_preprocess = false>
-u8* OpcodeDecoder_Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call = false);
+u8* OpcodeDecoder_Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call = false, u32* incomplete_size = nullptr);
@@ -30,16 +30,29 @@ std::string Statistics::ToString()
 	str += StringFromFormat("Textures created: %i\n", stats.numTexturesCreated);
 	str += StringFromFormat("Textures uploaded: %i\n", stats.numTexturesUploaded);
 	str += StringFromFormat("Textures alive: %i\n", stats.numTexturesAlive);
+	if (stats.thisFrame.numTextureHashesAvoided)
+		str += StringFromFormat("Texture hashes avoided: %i\n", stats.thisFrame.numTextureHashesAvoided);
 	str += StringFromFormat("pshaders created: %i\n", stats.numPixelShadersCreated);
 	str += StringFromFormat("pshaders alive: %i\n", stats.numPixelShadersAlive);
 	str += StringFromFormat("vshaders created: %i\n", stats.numVertexShadersCreated);
 	str += StringFromFormat("vshaders alive: %i\n", stats.numVertexShadersAlive);
 	str += StringFromFormat("shaders changes: %i\n", stats.thisFrame.numShaderChanges);
 	str += StringFromFormat("dlists called: %i\n", stats.thisFrame.numDListsCalled);
+	if (stats.thisFrame.numDListsReplayed)
+		str += StringFromFormat("dlists replayed: %i\n", stats.thisFrame.numDListsReplayed);
 	str += StringFromFormat("Primitive joins: %i\n", stats.thisFrame.numPrimitiveJoins);
 	str += StringFromFormat("Draw calls: %i\n", stats.thisFrame.numDrawCalls);
+	if (stats.thisFrame.numPerfQueryWaits)
+		str += StringFromFormat("Perf query waits: %i\n", stats.thisFrame.numPerfQueryWaits);
+	if (stats.thisFrame.numGpuWakeups)
+	{
+		str += StringFromFormat("GPU thread wakeups: %i (%i parked), %i us avg\n", stats.thisFrame.numGpuWakeups,
+		                        stats.thisFrame.numGpuWakeupsParked, stats.thisFrame.gpuWakeLatency / stats.thisFrame.numGpuWakeups);
+	}
 	str += StringFromFormat("Primitives: %i\n", stats.thisFrame.numPrims);
 	str += StringFromFormat("Primitives (DL): %i\n", stats.thisFrame.numDLPrims);
+	if (stats.thisFrame.numCachedVertices)
+		str += StringFromFormat("Vertices from DL cache: %i\n", stats.thisFrame.numCachedVertices);
 	str += StringFromFormat("XF loads: %i\n", stats.thisFrame.numXFLoads);
 	str += StringFromFormat("XF loads (DL): %i\n", stats.thisFrame.numXFLoadsInDL);
 	str += StringFromFormat("CP loads: %i\n", stats.thisFrame.numCPLoads);
@@ -48,19 +61,14 @@ std::string Statistics::ToString()
 	str += StringFromFormat("BP loads (DL): %i\n", stats.thisFrame.numBPLoadsInDL);
 	str += StringFromFormat("Vertex streamed: %i kB\n", stats.thisFrame.bytesVertexStreamed / 1024);
 	str += StringFromFormat("Index streamed: %i kB\n", stats.thisFrame.bytesIndexStreamed / 1024);
+	if (stats.thisFrame.bytesVertexReused || stats.thisFrame.bytesIndexReused)
+	{
+		str += StringFromFormat("Vertex reused: %i kB\n", stats.thisFrame.bytesVertexReused / 1024);
+		str += StringFromFormat("Index reused: %i kB\n", stats.thisFrame.bytesIndexReused / 1024);
+	}
 	str += StringFromFormat("Uniform streamed: %i kB\n", stats.thisFrame.bytesUniformStreamed / 1024);
 	str += StringFromFormat("Vertex Loaders: %i\n", stats.numVertexLoaders);
-
-	std::string vertex_list;
-	VertexLoaderManager::AppendListToString(&vertex_list);
-
-	// TODO : at some point text1 just becomes too huge and overflows, we can't even read the added stuff
-	// since it gets added at the far bottom of the screen anyway (actually outside the rendering window)
-	// we should really reset the list instead of using substr
-	if (vertex_list.size() + str.size() > 8170)
-		vertex_list = vertex_list.substr(0, 8170 - str.size());
-
-	str += vertex_list;
+	VertexLoaderManager::AppendListToString(&str, 8);
 
 	return str;
 }
@@ -50,9 +50,20 @@ struct Statistics
 		int numDrawCalls;
 
 		int numDListsCalled;
+		int numDListsReplayed;
+
+		int numTextureHashesAvoided;
+		int numCachedVertices;
+		int numPerfQueryWaits;
+
+		int numGpuWakeups;
+		int numGpuWakeupsParked;
+		int gpuWakeLatency; // in us, summed up
 
 		int bytesVertexStreamed;
 		int bytesIndexStreamed;
+		int bytesVertexReused;
+		int bytesIndexReused;
 		int bytesUniformStreamed;
 	};
 	ThisFrame thisFrame;
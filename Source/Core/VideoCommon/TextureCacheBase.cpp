@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <string>
+#include <unordered_map>
 
 #include "Common/FileUtil.h"
 #include "Common/MemoryUtil.h"
@@ -38,6 +39,38 @@ TextureCache::BackupConfig TextureCache::backup_config;
 
 static bool invalidate_texture_cache_requested;
 
+// Hashes of RAM ranges that are write watched, keyed by address and size.
+// A hash stays valid as long as Memory::IsRangeUnmodified() says so.
+struct WatchedHash
+{
+	u64 hash;
+	u64 stamp;
+};
+static const size_t MAX_WATCHED_HASHES = 4096;
+static std::unordered_map<u64, WatchedHash> s_watched_hashes;
+
+static u64 GetWatchedHash(u32 address, const u8* src_data, u32 size)
+{
+	const u64 key = ((u64)address << 32) | size;
+	auto iter = s_watched_hashes.find(key);
+	if (iter != s_watched_hashes.end() && Memory::IsRangeUnmodified(address, size, iter->second.stamp))
+	{
+		INCSTAT(stats.thisFrame.numTextureHashesAvoided);
+		return iter->second.hash;
+	}
+
+	// Start watching before hashing, so writes during the hash aren't lost.
+	const u64 stamp = Memory::WatchRange(address, size);
+	const u64 hash = GetHash64(src_data, size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+	if (stamp == 0)
+		return hash;
+
+	if (s_watched_hashes.size() >= MAX_WATCHED_HASHES)
+		s_watched_hashes.clear();
+	s_watched_hashes[key] = { hash, stamp };
+	return hash;
+}
+
 TextureCache::TCacheEntryBase::~TCacheEntryBase()
 {
 }
@@ -59,6 +92,7 @@ TextureCache::TextureCache()
 		temp = (u8*)AllocateAlignedMemory(temp_size, 16);
 
 	TexDecoder_SetTexFmtOverlayOptions(g_ActiveConfig.bTexFmtOverlayEnable, g_ActiveConfig.bTexFmtOverlayCenter);
+	TexDecoder_SetThreadingOptions(g_ActiveConfig.bMultithreadedTextureDecoding ? std::max(g_ActiveConfig.iTextureDecodingThreshold, 1) : 0);
 
 	if (g_ActiveConfig.bHiresTextures && !g_ActiveConfig.bDumpTextures)
 		HiresTexture::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID);
@@ -88,11 +122,14 @@ void TextureCache::Invalidate()
 		delete rt.second;
 	}
 	texture_pool.clear();
+
+	s_watched_hashes.clear();
 }
 
 TextureCache::~TextureCache()
 {
 	Invalidate();
+	TexDecoder_Shutdown();
 	FreeAlignedMemory(temp);
 	temp = nullptr;
 }
@@ -108,6 +145,8 @@ void TextureCache::OnConfigChanged(VideoConfig& config)
 			config.bHiresTextures != backup_config.s_hires_textures ||
 			invalidate_texture_cache_requested)
 		{
+			// Deleted entries drop their pending copies
+			g_texture_cache->FlushAllEFBCopies();
 			g_texture_cache->Invalidate();
 
 			if (g_ActiveConfig.bHiresTextures)
@@ -118,6 +157,12 @@ void TextureCache::OnConfigChanged(VideoConfig& config)
 			invalidate_texture_cache_requested = false;
 		}
 
+		if (config.bMultithreadedTextureDecoding != backup_config.s_threaded_decoding ||
+			config.iTextureDecodingThreshold != backup_config.s_decoding_threshold)
+		{
+			TexDecoder_SetThreadingOptions(config.bMultithreadedTextureDecoding ? std::max(config.iTextureDecodingThreshold, 1) : 0);
+		}
+
 		if ((config.iStereoMode > 0) != backup_config.s_stereo_3d ||
 			config.bStereoEFBMonoDepth != backup_config.s_efb_mono_depth)
 		{
@@ -132,6 +177,8 @@ void TextureCache::OnConfigChanged(VideoConfig& config)
 	backup_config.s_hires_textures = config.bHiresTextures;
 	backup_config.s_stereo_3d = config.iStereoMode > 0;
 	backup_config.s_efb_mono_depth = config.bStereoEFBMonoDepth;
+	backup_config.s_threaded_decoding = config.bMultithreadedTextureDecoding;
+	backup_config.s_decoding_threshold = config.iTextureDecodingThreshold;
 }
 
 void TextureCache::Cleanup(int _frameCount)
@@ -300,9 +347,18 @@ TextureCache::TCacheEntryBase* TextureCache::Load(const u32 stage)
 
 	const u8* src_data;
 	if (from_tmem)
+	{
 		src_data = &texMem[bpmem.tex[stage / 4].texImage1[stage % 4].tmem_even * TMEM_LINE_SIZE];
+	}
 	else
+	{
+		// The mipmaps are read further down, so don't bother with their exact size
+		if (tex_levels > 1)
+			g_texture_cache->FlushAllEFBCopies();
+		else
+			g_texture_cache->FlushEFBCopies(address, texture_size);
 		src_data = Memory::GetPointer(address);
+	}
 
 	// TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data from the low tmem bank than it should)
 	if (src_data == nullptr)
@@ -310,6 +366,8 @@ TextureCache::TCacheEntryBase* TextureCache::Load(const u32 stage)
 		ERROR_LOG(VIDEO, "TextureCache::Load has an address in Wii memory (%8x) but not in real memory (NULL)!", address);
 		return nullptr;
 	}
+	else if (!from_tmem && g_ActiveConfig.bWatchTextureMemory && Memory::IsWriteWatchEnabled())
+		tex_hash = GetWatchedHash(address, src_data, texture_size);
 	else
 		tex_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
 
@@ -465,7 +523,12 @@ TextureCache::TCacheEntryBase* TextureCache::Load(const u32 stage)
 		}
 	}
 
-	if (!hires_tex)
+	// Let the backend decode the texture with shaders instead of the CPU
+	const bool decode_on_gpu = !hires_tex && !from_tmem &&
+		g_ActiveConfig.bGPUTextureDecoding && g_ActiveConfig.backend_info.bSupportsGPUTextureDecoding &&
+		g_texture_cache->SupportsGPUTextureDecode(texformat, (TlutFormat)tlutfmt, texture_size);
+
+	if (!hires_tex && !decode_on_gpu)
 	{
 		if (!(texformat == GX_TF_RGBA8 && from_tmem))
 		{
@@ -487,6 +550,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(const u32 stage)
 	config.width = width;
 	config.height = height;
 	config.levels = texLevels;
+	config.rendertarget = decode_on_gpu;
 
 	TCacheEntryBase* entry = AllocateTexture(config);
 	GFX_DEBUGGER_PAUSE_AT(NEXT_NEW_TEXTURE, true);
@@ -500,7 +564,15 @@ TextureCache::TCacheEntryBase* TextureCache::Load(const u32 stage)
 	entry->is_custom_tex = hires_tex != nullptr;
 
 	// load texture
-	entry->Load(width, height, expandedWidth, 0);
+	if (decode_on_gpu)
+	{
+		g_texture_cache->DecodeTextureOnGPU(entry, 0, src_data, texture_size, texformat, width, height,
+			expandedWidth, expandedHeight, &texMem[tlutaddr], (TlutFormat)tlutfmt);
+	}
+	else
+	{
+		entry->Load(width, height, expandedWidth, 0);
+	}
 
 	std::string basename = "";
 	if (g_ActiveConfig.bDumpTextures && !hires_tex)
@@ -549,10 +621,18 @@ TextureCache::TCacheEntryBase* TextureCache::Load(const u32 stage)
 				? ((level % 2) ? ptr_odd : ptr_even)
 				: src_data;
 			const u8* tlut = &texMem[tlutaddr];
-			TexDecoder_Decode(temp, mip_src_data, expanded_mip_width, expanded_mip_height, texformat, tlut, (TlutFormat)tlutfmt);
-			mip_src_data += TexDecoder_GetTextureSizeInBytes(expanded_mip_width, expanded_mip_height, texformat);
-
-			entry->Load(mip_width, mip_height, expanded_mip_width, level);
+			const u32 mip_size = TexDecoder_GetTextureSizeInBytes(expanded_mip_width, expanded_mip_height, texformat);
+			if (decode_on_gpu)
+			{
+				g_texture_cache->DecodeTextureOnGPU(entry, level, mip_src_data, mip_size, texformat, mip_width, mip_height,
+					expanded_mip_width, expanded_mip_height, tlut, (TlutFormat)tlutfmt);
+			}
+			else
+			{
+				TexDecoder_Decode(temp, mip_src_data, expanded_mip_width, expanded_mip_height, texformat, tlut, (TlutFormat)tlutfmt);
+				entry->Load(mip_width, mip_height, expanded_mip_width, level);
+			}
+			mip_src_data += mip_size;
 
 			if (g_ActiveConfig.bDumpTextures)
 				DumpTexture(entry, basename, level);
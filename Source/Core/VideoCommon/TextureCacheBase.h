@@ -124,6 +124,20 @@ public:
 
 	virtual void ConvertTexture(TCacheEntryBase* entry, TCacheEntryBase* unconverted, void* palette, TlutFormat format) = 0;
 
+	// Decoding raw texture data with shaders, entry must have been created as a render target.
+	// data_size is the size of the first level, textures the backend can't decode stay on the CPU.
+	virtual bool SupportsGPUTextureDecode(int format, TlutFormat palette_format, u32 data_size) { return false; }
+	virtual void DecodeTextureOnGPU(TCacheEntryBase* entry, u32 dst_level, const u8* data, u32 data_size,
+		int format, u32 width, u32 height, u32 aligned_width, u32 aligned_height,
+		const u8* palette, TlutFormat palette_format) {}
+
+	// Backends which leave EFB copies to RAM on the GPU for a while write them
+	// out here, every copy overlapping the range and all copies made before it.
+	virtual void FlushEFBCopies(u32 address, u32 size) {}
+	void FlushAllEFBCopies() { FlushEFBCopies(0, 0xFFFFFFFF); }
+	// Drops pending copies without writing them, when RAM has been replaced by a savestate.
+	virtual void DiscardEFBCopies() {}
+
 protected:
 	TextureCache();
 
@@ -156,6 +170,8 @@ private:
 		bool s_copy_cache_enable;
 		bool s_stereo_3d;
 		bool s_efb_mono_depth;
+		bool s_threaded_decoding;
+		int s_decoding_threshold;
 	} backup_config;
 };
 
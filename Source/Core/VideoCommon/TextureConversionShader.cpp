@@ -672,4 +672,159 @@ const char *GenerateEncodingShader(u32 format,API_TYPE ApiType)
 	return text;
 }
 
+// The raw texture data (and palette) is read bytewise from a buffer texture.
+// The results must match the CPU decoders in TextureDecoder_*.cpp exactly.
+static void WriteDecoderHeader(char*& p, u32 format)
+{
+	const int blkW = TexDecoder_GetBlockWidthInTexels(format);
+	const int blkH = TexDecoder_GetBlockHeightInTexels(format);
+	const int blkSize = blkW * blkH * TexDecoder_GetTexelSizeInNibbles(format) / 2;
+
+	// x: offset of the texture data, y: width in blocks, z: offset of the palette
+	WRITE(p, "uniform int4 decode_params;\n");
+	WRITE(p, "SAMPLER_BINDING(10) uniform usamplerBuffer samp10;\n");
+	WRITE(p, "out float4 ocol0;\n");
+
+	WRITE(p, "int Fetch8(int offset) { return int(texelFetch(samp10, offset).r); }\n");
+	WRITE(p, "int Fetch16(int offset) { return (Fetch8(offset) << 8) | Fetch8(offset + 1); }\n");
+	WRITE(p, "int Convert3To8(int v) { return (v << 5) | (v << 2) | (v >> 1); }\n");
+	WRITE(p, "int Convert4To8(int v) { return (v << 4) | v; }\n");
+	WRITE(p, "int Convert5To8(int v) { return (v << 3) | (v >> 2); }\n");
+	WRITE(p, "int Convert6To8(int v) { return (v << 2) | (v >> 4); }\n");
+
+	WRITE(p, "int4 DecodePixel_IA8(int val)\n");
+	WRITE(p, "{\n");
+	WRITE(p, "  int i = val & 0xFF;\n");
+	WRITE(p, "  return int4(i, i, i, val >> 8);\n");
+	WRITE(p, "}\n");
+	WRITE(p, "int4 DecodePixel_RGB565(int val)\n");
+	WRITE(p, "{\n");
+	WRITE(p, "  return int4(Convert5To8((val >> 11) & 0x1f), Convert6To8((val >> 5) & 0x3f), Convert5To8(val & 0x1f), 0xFF);\n");
+	WRITE(p, "}\n");
+	WRITE(p, "int4 DecodePixel_RGB5A3(int val)\n");
+	WRITE(p, "{\n");
+	WRITE(p, "  if ((val & 0x8000) != 0)\n");
+	WRITE(p, "    return int4(Convert5To8((val >> 10) & 0x1f), Convert5To8((val >> 5) & 0x1f), Convert5To8(val & 0x1f), 0xFF);\n");
+	WRITE(p, "  else\n");
+	WRITE(p, "    return int4(Convert4To8((val >> 8) & 0xf), Convert4To8((val >> 4) & 0xf), Convert4To8(val & 0xf), Convert3To8((val >> 12) & 0x7));\n");
+	WRITE(p, "}\n");
+
+	WRITE(p, "void main()\n");
+	WRITE(p, "{\n");
+	WRITE(p, "  int2 coords = int2(gl_FragCoord.xy);\n");
+	WRITE(p, "  int2 block = coords / int2(%d, %d);\n", blkW, blkH);
+	WRITE(p, "  int2 texel = coords - block * int2(%d, %d);\n", blkW, blkH);
+	WRITE(p, "  int block_offset = decode_params.x + (block.y * decode_params.y + block.x) * %d;\n", blkSize);
+	WRITE(p, "  int4 color;\n");
+}
+
+static void WriteDecoderEnd(char*& p)
+{
+	WRITE(p, "  ocol0 = float4(color) / 255.0;\n");
+	WRITE(p, "}\n");
+}
+
+static void WritePaletteLookup(char*& p, const char* index, TlutFormat tlutfmt)
+{
+	const char* decoder = tlutfmt == GX_TL_IA8 ? "DecodePixel_IA8" :
+	                      tlutfmt == GX_TL_RGB565 ? "DecodePixel_RGB565" : "DecodePixel_RGB5A3";
+	WRITE(p, "  color = %s(Fetch16(decode_params.z + (%s) * 2));\n", decoder, index);
+}
+
+const char *GenerateDecodingShader(u32 format, TlutFormat tlutfmt, API_TYPE ApiType)
+{
+	if (ApiType != API_OPENGL || tlutfmt > GX_TL_RGB5A3)
+		return nullptr;
+
+	text[sizeof(text) - 1] = 0x7C;  // canary
+
+	char *p = text;
+
+	switch (format)
+	{
+	case GX_TF_I4:
+		WriteDecoderHeader(p, format);
+		WRITE(p, "  int val = Fetch8(block_offset + texel.y * 4 + (texel.x >> 1));\n");
+		WRITE(p, "  int i = Convert4To8((texel.x & 1) == 0 ? (val >> 4) : (val & 0xF));\n");
+		WRITE(p, "  color = int4(i, i, i, i);\n");
+		break;
+	case GX_TF_I8:
+		WriteDecoderHeader(p, format);
+		WRITE(p, "  int i = Fetch8(block_offset + texel.y * 8 + texel.x);\n");
+		WRITE(p, "  color = int4(i, i, i, i);\n");
+		break;
+	case GX_TF_IA4:
+		WriteDecoderHeader(p, format);
+		WRITE(p, "  int val = Fetch8(block_offset + texel.y * 8 + texel.x);\n");
+		WRITE(p, "  int i = Convert4To8(val & 0xF);\n");
+		WRITE(p, "  color = int4(i, i, i, Convert4To8(val >> 4));\n");
+		break;
+	case GX_TF_IA8:
+		WriteDecoderHeader(p, format);
+		WRITE(p, "  color = DecodePixel_IA8(Fetch16(block_offset + (texel.y * 4 + texel.x) * 2));\n");
+		break;
+	case GX_TF_RGB565:
+		WriteDecoderHeader(p, format);
+		WRITE(p, "  color = DecodePixel_RGB565(Fetch16(block_offset + (texel.y * 4 + texel.x) * 2));\n");
+		break;
+	case GX_TF_RGB5A3:
+		WriteDecoderHeader(p, format);
+		WRITE(p, "  color = DecodePixel_RGB5A3(Fetch16(block_offset + (texel.y * 4 + texel.x) * 2));\n");
+		break;
+	case GX_TF_RGBA8:
+		// Each block holds 16 AR pairs followed by 16 GB pairs.
+		WriteDecoderHeader(p, format);
+		WRITE(p, "  int ar = block_offset + (texel.y * 4 + texel.x) * 2;\n");
+		WRITE(p, "  color = int4(Fetch8(ar + 1), Fetch8(ar + 32), Fetch8(ar + 33), Fetch8(ar));\n");
+		break;
+	case GX_TF_C4:
+		WriteDecoderHeader(p, format);
+		WRITE(p, "  int val = Fetch8(block_offset + texel.y * 4 + (texel.x >> 1));\n");
+		WritePaletteLookup(p, "(texel.x & 1) == 0 ? (val >> 4) : (val & 0xF)", tlutfmt);
+		break;
+	case GX_TF_C8:
+		WriteDecoderHeader(p, format);
+		WritePaletteLookup(p, "Fetch8(block_offset + texel.y * 8 + texel.x)", tlutfmt);
+		break;
+	case GX_TF_C14X2:
+		WriteDecoderHeader(p, format);
+		WritePaletteLookup(p, "Fetch16(block_offset + (texel.y * 4 + texel.x) * 2) & 0x3FFF", tlutfmt);
+		break;
+	case GX_TF_CMPR:
+		// 8x8 blocks made of four DXT1-like 4x4 subblocks of 8 bytes each.
+		WriteDecoderHeader(p, format);
+		WRITE(p, "  int sub = block_offset + ((texel.y >> 2) * 2 + (texel.x >> 2)) * 8;\n");
+		WRITE(p, "  int c1 = Fetch16(sub);\n");
+		WRITE(p, "  int c2 = Fetch16(sub + 2);\n");
+		WRITE(p, "  int lines = Fetch8(sub + 4 + (texel.y & 3));\n");
+		WRITE(p, "  int sel = (lines >> (6 - (texel.x & 3) * 2)) & 3;\n");
+		WRITE(p, "  int3 color1 = int3(Convert5To8((c1 >> 11) & 0x1F), Convert6To8((c1 >> 5) & 0x3F), Convert5To8(c1 & 0x1F));\n");
+		WRITE(p, "  int3 color2 = int3(Convert5To8((c2 >> 11) & 0x1F), Convert6To8((c2 >> 5) & 0x3F), Convert5To8(c2 & 0x1F));\n");
+		WRITE(p, "  if (sel == 0)\n");
+		WRITE(p, "    color = int4(color1, 255);\n");
+		WRITE(p, "  else if (sel == 1)\n");
+		WRITE(p, "    color = int4(color2, 255);\n");
+		WRITE(p, "  else if (c1 > c2)\n");
+		WRITE(p, "  {\n");
+		WRITE(p, "    int3 diff = color2 - color1;\n");
+		WRITE(p, "    int3 third = (diff >> 1) - (diff >> 3);\n");
+		WRITE(p, "    color = sel == 2 ? int4(color1 + third, 255) : int4(color2 - third, 255);\n");
+		WRITE(p, "  }\n");
+		WRITE(p, "  else\n");
+		WRITE(p, "  {\n");
+		WRITE(p, "    color = sel == 2 ? int4((color1 + color2 + 1) / 2, 255) : int4(color2, 0);\n");
+		WRITE(p, "  }\n");
+		break;
+	default:
+		return nullptr;
+	}
+
+	WriteDecoderEnd(p);
+
+	if (text[sizeof(text) - 1] != 0x7C)
+		PanicAlert("TextureConversionShader generator - buffer too small, canary has been eaten!");
+
+	return text;
+}
+
 }  // namespace
@@ -14,4 +14,8 @@ u16 GetEncodedSampleCount(u32 format);
 
 const char *GenerateEncodingShader(u32 format, API_TYPE ApiType = API_OPENGL);
 
+// Pixel shader decoding a texture from its raw GameCube layout, one texel per
+// fragment. Returns nullptr if the format can't be decoded on the GPU.
+const char *GenerateDecodingShader(u32 format, TlutFormat tlutfmt, API_TYPE ApiType = API_OPENGL);
+
 }
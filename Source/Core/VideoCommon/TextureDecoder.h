@@ -72,6 +72,9 @@ void TexDecoder_DecodeTexel(u8 *dst, const u8 *src, int s, int t, int imageWidth
 void TexDecoder_DecodeTexelRGBA8FromTmem(u8 *dst, const u8 *src_ar, const u8* src_gb, int s, int t, int imageWidth);
 
 void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center);
+// Textures with at least min_texels texels are decoded on several threads; 0 disables this.
+void TexDecoder_SetThreadingOptions(u32 min_texels);
+void TexDecoder_Shutdown();
 
 /* Internal method, implemented by TextureDecoder_Generic and TextureDecoder_x64. */
 void _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int height, int texformat, const u8* tlut, TlutFormat tlutfmt);
@@ -3,9 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "Common/Common.h"
+#include "Common/Event.h"
+#include "Common/Flag.h"
+#include "Common/Thread.h"
 
 #include "VideoCommon/LookUpTables.h"
 #include "VideoCommon/sfont.inc"
@@ -14,6 +21,29 @@
 static bool TexFmt_Overlay_Enable = false;
 static bool TexFmt_Overlay_Center = false;
 
+// Rows of blocks decode independently of each other, so large textures are
+// split into ranges of block rows which are decoded on a pool of threads.
+// Range 0 is decoded by the thread calling TexDecoder_Decode itself.
+static u32 s_decode_min_texels;
+static std::vector<std::thread> s_decode_threads;
+static std::vector<std::unique_ptr<Common::Event>> s_decode_start_events;
+static Common::Event s_decode_done_event;
+static std::atomic<int> s_decode_pending;
+static Common::Flag s_decode_threads_running;
+
+static struct
+{
+	u32* dst;
+	const u8* src;
+	int width;
+	int height;
+	int block_height;
+	int texformat;
+	const u8* tlut;
+	TlutFormat tlutfmt;
+	int num_ranges;
+} s_decode_job;
+
 // TRAM
 // STATE_TO_SAVE
 GC_ALIGNED16(u8 texMem[TMEM_SIZE]);
@@ -153,6 +183,76 @@ void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center)
 	TexFmt_Overlay_Center = center;
 }
 
+static void DecodeRange(int index)
+{
+	const int block_rows = (s_decode_job.height + s_decode_job.block_height - 1) / s_decode_job.block_height;
+	const int first_row = block_rows * index / s_decode_job.num_ranges;
+	const int last_row = block_rows * (index + 1) / s_decode_job.num_ranges;
+	if (first_row == last_row)
+		return;
+
+	const int y = first_row * s_decode_job.block_height;
+	const int height = std::min(last_row * s_decode_job.block_height, s_decode_job.height) - y;
+	_TexDecoder_DecodeImpl(s_decode_job.dst + y * s_decode_job.width,
+	                       s_decode_job.src + TexDecoder_GetTextureSizeInBytes(s_decode_job.width, y, s_decode_job.texformat),
+	                       s_decode_job.width, height, s_decode_job.texformat, s_decode_job.tlut, s_decode_job.tlutfmt);
+}
+
+static void DecodeThread(int index)
+{
+	Common::SetCurrentThreadName("Texture decoder");
+
+	while (true)
+	{
+		s_decode_start_events[index - 1]->Wait();
+		if (!s_decode_threads_running.IsSet())
+			return;
+
+		DecodeRange(index);
+
+		if (--s_decode_pending == 0)
+			s_decode_done_event.Set();
+	}
+}
+
+void TexDecoder_Shutdown()
+{
+	s_decode_threads_running.Clear();
+	for (auto& start_event : s_decode_start_events)
+		start_event->Set();
+	for (std::thread& thread : s_decode_threads)
+		thread.join();
+
+	s_decode_threads.clear();
+	s_decode_start_events.clear();
+	s_decode_min_texels = 0;
+}
+
+void TexDecoder_SetThreadingOptions(u32 min_texels)
+{
+	if (min_texels == s_decode_min_texels)
+		return;
+
+	TexDecoder_Shutdown();
+	if (min_texels == 0)
+		return;
+
+	// Leave room for the CPU and GPU threads; more threads barely help
+	// since decoding soon becomes limited by memory bandwidth.
+	u32 num_threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	num_threads = std::min(num_threads, 4u);
+	if (num_threads <= 1)
+		return;
+
+	s_decode_min_texels = min_texels;
+	s_decode_threads_running.Set();
+	for (u32 i = 1; i < num_threads; i++)
+	{
+		s_decode_start_events.emplace_back(new Common::Event());
+		s_decode_threads.emplace_back(DecodeThread, i);
+	}
+}
+
 static const char* texfmt[] = {
 	// pixel
 	"I4",      "I8",      "IA4",      "IA8",
@@ -221,7 +321,32 @@ static void TexDecoder_DrawOverlay(u8 *dst, int width, int height, int texformat
 
 void TexDecoder_Decode(u8 *dst, const u8 *src, int width, int height, int texformat, const u8* tlut, TlutFormat tlutfmt)
 {
-	_TexDecoder_DecodeImpl((u32*)dst, src, width, height, texformat, tlut, tlutfmt);
+	const int block_height = TexDecoder_GetBlockHeightInTexels(texformat);
+	if (!s_decode_threads.empty() && (u32)(width * height) >= s_decode_min_texels && height > block_height &&
+	    width % TexDecoder_GetBlockWidthInTexels(texformat) == 0)
+	{
+		s_decode_job.dst = (u32*)dst;
+		s_decode_job.src = src;
+		s_decode_job.width = width;
+		s_decode_job.height = height;
+		s_decode_job.block_height = block_height;
+		s_decode_job.texformat = texformat;
+		s_decode_job.tlut = tlut;
+		s_decode_job.tlutfmt = tlutfmt;
+		s_decode_job.num_ranges = (int)s_decode_threads.size() + 1;
+
+		s_decode_pending = (int)s_decode_threads.size();
+		for (auto& start_event : s_decode_start_events)
+			start_event->Set();
+
+		DecodeRange(0);
+
+		s_decode_done_event.Wait();
+	}
+	else
+	{
+		_TexDecoder_DecodeImpl((u32*)dst, src, width, height, texformat, tlut, tlutfmt);
+	}
 
 	if (TexFmt_Overlay_Enable)
 		TexDecoder_DrawOverlay(dst, width, height, texformat);
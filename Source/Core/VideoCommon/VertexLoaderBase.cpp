@@ -19,6 +19,7 @@
 VertexLoaderBase::VertexLoaderBase(const TVtxDesc &vtx_desc, const VAT &vtx_attr)
 {
 	m_numLoadedVertices = 0;
+	m_loadTime = 0;
 	m_VertexSize = 0;
 	m_native_vertex_format = nullptr;
 	m_native_components = 0;
@@ -120,7 +121,7 @@ void VertexLoaderBase::AppendToString(std::string *dest) const
 				i, m_VtxAttr.texCoord[i].Elements, posMode[tex_mode[i]], posFormats[m_VtxAttr.texCoord[i].Format]));
 		}
 	}
-	dest->append(StringFromFormat(" - %i v\n", m_numLoadedVertices));
+	dest->append(StringFromFormat(" - %i v, %.2f ms\n", m_numLoadedVertices, m_loadTime / 1000000.0));
 }
 
 // a hacky implementation to compare two vertex loaders
@@ -91,6 +91,7 @@ public:
 	// used by VertexLoaderManager
 	NativeVertexFormat* m_native_vertex_format;
 	int m_numLoadedVertices;
+	u64 m_loadTime; // in ns, only measured while the statistics overlay is shown
 
 protected:
 	VertexLoaderBase(const TVtxDesc &vtx_desc, const VAT &vtx_attr);
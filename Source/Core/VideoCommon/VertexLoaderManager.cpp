@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -10,10 +11,16 @@
 #include <vector>
 
 #include "Common/CommonFuncs.h"
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+#include "Common/LinearDiskCache.h"
+#include "Common/StringUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/Memmap.h"
 
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/DisplayListCache.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderBase.h"
@@ -21,6 +28,7 @@
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/VR.h"
 
 
@@ -37,6 +45,51 @@ static std::mutex s_vertex_loader_map_lock;
 static VertexLoaderMap s_vertex_loader_map;
 // TODO - change into array of pointers. Keep a map of all seen so far.
 
+// The vertex formats a game has used, so that their loaders can be created
+// at boot instead of on the first draw which uses them
+struct VertexLoaderCacheKey
+{
+	u32 vtx_desc[2];
+	u32 vat[3];
+};
+static LinearDiskCache<VertexLoaderCacheKey, u8> s_vertex_loader_cache;
+
+static NativeVertexFormat* GetNativeVertexFormat(const VertexLoaderBase* loader)
+{
+	// search for a cached native vertex format
+	const PortableVertexDeclaration& format = loader->m_native_vtx_decl;
+	std::unique_ptr<NativeVertexFormat>& native = s_native_vertex_map[format];
+	if (!native)
+	{
+		native.reset(g_vertex_manager->CreateNativeVertexFormat());
+		native->Initialize(format);
+		native->m_components = loader->m_native_components;
+	}
+	return native.get();
+}
+
+class VertexLoaderCacheInserter : public LinearDiskCacheReader<VertexLoaderCacheKey, u8>
+{
+public:
+	void Read(const VertexLoaderCacheKey& key, const u8* value, u32 value_size) override
+	{
+		TVtxDesc vtx_desc;
+		VAT vat;
+		vtx_desc.Hex = key.vtx_desc[0] | ((u64)key.vtx_desc[1] << 32);
+		vat.g0.Hex = key.vat[0];
+		vat.g1.Hex = key.vat[1];
+		vat.g2.Hex = key.vat[2];
+
+		std::unique_ptr<VertexLoaderBase>& loader = s_vertex_loader_map[VertexLoaderUID(vtx_desc, vat)];
+		if (loader)
+			return;
+
+		loader.reset(VertexLoaderBase::CreateVertexLoader(vtx_desc, vat));
+		loader->m_native_vertex_format = GetNativeVertexFormat(loader.get());
+		INCSTAT(stats.numVertexLoaders);
+	}
+};
+
 void Init()
 {
 	MarkAllDirty();
@@ -46,11 +99,27 @@ void Init()
 		map_entry = nullptr;
 	RecomputeCachedArraybases();
 	SETSTAT(stats.numVertexLoaders, 0);
+
+	const std::string& game_id = SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID;
+	if (!game_id.empty())
+	{
+		if (!File::Exists(File::GetUserPath(D_CACHE_IDX)))
+			File::CreateDir(File::GetUserPath(D_CACHE_IDX));
+
+		std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
+		VertexLoaderCacheInserter inserter;
+		s_vertex_loader_cache.OpenAndRead(StringFromFormat("%svertexloaders-%s.cache",
+			File::GetUserPath(D_CACHE_IDX).c_str(), game_id.c_str()), inserter);
+	}
 }
 
 void Shutdown()
 {
+	DisplayListCache::Shutdown();
+
 	std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
+	s_vertex_loader_cache.Sync();
+	s_vertex_loader_cache.Close();
 	s_vertex_loader_map.clear();
 	s_native_vertex_map.clear();
 }
@@ -68,7 +137,7 @@ struct entry
 };
 }
 
-void AppendListToString(std::string *dest)
+void AppendListToString(std::string *dest, size_t max_entries)
 {
 	std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
 	std::vector<entry> entries;
@@ -83,6 +152,8 @@ void AppendListToString(std::string *dest)
 		total_size += e.text.size() + 1;
 	}
 	sort(entries.begin(), entries.end());
+	if (entries.size() > max_entries)
+		entries.resize(max_entries);
 	dest->reserve(dest->size() + total_size);
 	for (const entry& entry : entries)
 	{
@@ -119,20 +190,17 @@ static VertexLoaderBase* RefreshLoader(int vtx_attr_group, bool preprocess = fal
 			loader = VertexLoaderBase::CreateVertexLoader(state->vtx_desc, state->vtx_attr[vtx_attr_group]);
 			s_vertex_loader_map[uid] = std::unique_ptr<VertexLoaderBase>(loader);
 			INCSTAT(stats.numVertexLoaders);
+
+			VertexLoaderCacheKey key;
+			key.vtx_desc[0] = state->vtx_desc.Hex & 0xFFFFFFFF;
+			key.vtx_desc[1] = state->vtx_desc.Hex >> 32;
+			key.vat[0] = state->vtx_attr[vtx_attr_group].g0.Hex;
+			key.vat[1] = state->vtx_attr[vtx_attr_group].g1.Hex;
+			key.vat[2] = state->vtx_attr[vtx_attr_group].g2.Hex;
+			s_vertex_loader_cache.Append(key, nullptr, 0);
 		}
 		if (check_for_native_format)
-		{
-			// search for a cached native vertex format
-			const PortableVertexDeclaration& format = loader->m_native_vtx_decl;
-			std::unique_ptr<NativeVertexFormat>& native = s_native_vertex_map[format];
-			if (!native)
-			{
-				native.reset(g_vertex_manager->CreateNativeVertexFormat());
-				native->Initialize(format);
-				native->m_components = loader->m_native_components;
-			}
-			loader->m_native_vertex_format = native.get();
-		}
+			loader->m_native_vertex_format = GetNativeVertexFormat(loader);
 		state->vertex_loaders[vtx_attr_group] = loader;
 		state->attr_dirty[vtx_attr_group] = false;
 	} else {
@@ -151,7 +219,7 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
 	VertexLoaderBase* loader = RefreshLoader(vtx_attr_group, is_preprocess);
 	int size = count * loader->m_VertexSize;
 	if ((int)src.size() < size)
-		return -1;
+		return -size;
 
 #ifdef DEBUG_OBJECTS
 	if (skip_objects_count < m_LocalCoreStartupParameter.skip_objects_end_two)
@@ -216,7 +284,20 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
 	DataReader dst = VertexManager::PrepareForAdditionalData(primitive, count,
 			loader->m_native_vtx_decl.stride, cullall);
 
-	count = loader->RunVertices(src, dst, count, primitive);
+	if (g_ActiveConfig.bOverlayStats)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		count = DisplayListCache::RunVertices(loader, vtx_attr_group, src, dst, count, primitive);
+		auto end = std::chrono::high_resolution_clock::now();
+		loader->m_loadTime += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	}
+	else
+	{
+		count = DisplayListCache::RunVertices(loader, vtx_attr_group, src, dst, count, primitive);
+	}
+
+	if (BoundingBox::active && g_ActiveConfig.iBBoxMode != BBOX_ACCURATE && !cullall)
+		BoundingBox::Estimate(dst.GetPointer(), count, primitive, loader->m_native_vtx_decl);
 
 	IndexGenerator::AddIndices(primitive, count);
 
@@ -17,11 +17,11 @@ namespace VertexLoaderManager
 
 	void MarkAllDirty();
 
-	// Returns -1 if buf_size is insufficient, else the amount of bytes consumed
+	// Returns minus the amount of bytes needed if buf_size is insufficient, else the amount of bytes consumed
 	int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bool skip_drawing, bool is_preprocess);
 
-	// For debugging
-	void AppendListToString(std::string *dest);
+	// For debugging, lists the loaders which loaded the most vertices first
+	void AppendListToString(std::string *dest, size_t max_entries = (size_t)-1);
 
 	NativeVertexFormat* GetCurrentVertexFormat();
 }
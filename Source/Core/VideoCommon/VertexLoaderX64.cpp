@@ -15,12 +15,46 @@ static const X64Reg scratch3 = ABI_PARAM4;
 static const X64Reg count_reg = R10;
 static const X64Reg skipped_reg = R11;
 
+static const __m128i shuffle_lut[4][3] = {
+	{_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF00L),  // 1x u8
+	 _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF01L, 0xFFFFFF00L),  // 2x u8
+	 _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFF02L, 0xFFFFFF01L, 0xFFFFFF00L)}, // 3x u8
+	{_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00FFFFFFL),  // 1x s8
+	 _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL),  // 2x s8
+	 _mm_set_epi32(0xFFFFFFFFL, 0x02FFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL)}, // 3x s8
+	{_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0001L),  // 1x u16
+	 _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0203L, 0xFFFF0001L),  // 2x u16
+	 _mm_set_epi32(0xFFFFFFFFL, 0xFFFF0405L, 0xFFFF0203L, 0xFFFF0001L)}, // 3x u16
+	{_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x0001FFFFL),  // 1x s16
+	 _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x0203FFFFL, 0x0001FFFFL),  // 2x s16
+	 _mm_set_epi32(0xFFFFFFFFL, 0x0405FFFFL, 0x0203FFFFL, 0x0001FFFFL)}, // 3x s16
+};
+static const __m128 scale_factors[32] = {
+	_mm_set_ps1(1./(1u<< 0)), _mm_set_ps1(1./(1u<< 1)), _mm_set_ps1(1./(1u<< 2)), _mm_set_ps1(1./(1u<< 3)),
+	_mm_set_ps1(1./(1u<< 4)), _mm_set_ps1(1./(1u<< 5)), _mm_set_ps1(1./(1u<< 6)), _mm_set_ps1(1./(1u<< 7)),
+	_mm_set_ps1(1./(1u<< 8)), _mm_set_ps1(1./(1u<< 9)), _mm_set_ps1(1./(1u<<10)), _mm_set_ps1(1./(1u<<11)),
+	_mm_set_ps1(1./(1u<<12)), _mm_set_ps1(1./(1u<<13)), _mm_set_ps1(1./(1u<<14)), _mm_set_ps1(1./(1u<<15)),
+	_mm_set_ps1(1./(1u<<16)), _mm_set_ps1(1./(1u<<17)), _mm_set_ps1(1./(1u<<18)), _mm_set_ps1(1./(1u<<19)),
+	_mm_set_ps1(1./(1u<<20)), _mm_set_ps1(1./(1u<<21)), _mm_set_ps1(1./(1u<<22)), _mm_set_ps1(1./(1u<<23)),
+	_mm_set_ps1(1./(1u<<24)), _mm_set_ps1(1./(1u<<25)), _mm_set_ps1(1./(1u<<26)), _mm_set_ps1(1./(1u<<27)),
+	_mm_set_ps1(1./(1u<<28)), _mm_set_ps1(1./(1u<<29)), _mm_set_ps1(1./(1u<<30)), _mm_set_ps1(1./(1u<<31)),
+};
+static const __m128i bswap_shuffle = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+// Byte offsets and masks of the dwords to gather for each vertex of a pair
+static const u32 gather_offsets[8] = { 0, 4, 8, 12, 0, 4, 8, 12 };
+static const u32 gather_masks[3][8] = {
+	{ 0xFFFFFFFF, 0, 0, 0, 0xFFFFFFFF, 0, 0, 0 },
+	{ 0xFFFFFFFF, 0xFFFFFFFF, 0, 0, 0xFFFFFFFF, 0xFFFFFFFF, 0, 0 },
+	{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0 },
+};
+
 VertexLoaderX64::VertexLoaderX64(const TVtxDesc& vtx_desc, const VAT& vtx_att) : VertexLoaderBase(vtx_desc, vtx_att)
 {
 	if (!IsInitialized())
 		return;
 
-	AllocCodeSpace(4096);
+	AllocCodeSpace(cpu_info.bAVX2 ? 8192 : 4096);
 	ClearCodeSpace();
 	GenerateVertexLoader();
 	WriteProtect();
@@ -65,31 +99,6 @@ OpArg VertexLoaderX64::GetVertexAddr(int array, u64 attribute)
 
 int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count_in, int count_out, bool dequantize, u8 scaling_exponent, AttributeFormat* native_format)
 {
-	static const __m128i shuffle_lut[4][3] = {
-		{_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF00L),  // 1x u8
-		 _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF01L, 0xFFFFFF00L),  // 2x u8
-		 _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFF02L, 0xFFFFFF01L, 0xFFFFFF00L)}, // 3x u8
-		{_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00FFFFFFL),  // 1x s8
-		 _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL),  // 2x s8
-		 _mm_set_epi32(0xFFFFFFFFL, 0x02FFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL)}, // 3x s8
-		{_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0001L),  // 1x u16
-		 _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0203L, 0xFFFF0001L),  // 2x u16
-		 _mm_set_epi32(0xFFFFFFFFL, 0xFFFF0405L, 0xFFFF0203L, 0xFFFF0001L)}, // 3x u16
-		{_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x0001FFFFL),  // 1x s16
-		 _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x0203FFFFL, 0x0001FFFFL),  // 2x s16
-		 _mm_set_epi32(0xFFFFFFFFL, 0x0405FFFFL, 0x0203FFFFL, 0x0001FFFFL)}, // 3x s16
-	};
-	static const __m128 scale_factors[32] = {
-		_mm_set_ps1(1./(1u<< 0)), _mm_set_ps1(1./(1u<< 1)), _mm_set_ps1(1./(1u<< 2)), _mm_set_ps1(1./(1u<< 3)),
-		_mm_set_ps1(1./(1u<< 4)), _mm_set_ps1(1./(1u<< 5)), _mm_set_ps1(1./(1u<< 6)), _mm_set_ps1(1./(1u<< 7)),
-		_mm_set_ps1(1./(1u<< 8)), _mm_set_ps1(1./(1u<< 9)), _mm_set_ps1(1./(1u<<10)), _mm_set_ps1(1./(1u<<11)),
-		_mm_set_ps1(1./(1u<<12)), _mm_set_ps1(1./(1u<<13)), _mm_set_ps1(1./(1u<<14)), _mm_set_ps1(1./(1u<<15)),
-		_mm_set_ps1(1./(1u<<16)), _mm_set_ps1(1./(1u<<17)), _mm_set_ps1(1./(1u<<18)), _mm_set_ps1(1./(1u<<19)),
-		_mm_set_ps1(1./(1u<<20)), _mm_set_ps1(1./(1u<<21)), _mm_set_ps1(1./(1u<<22)), _mm_set_ps1(1./(1u<<23)),
-		_mm_set_ps1(1./(1u<<24)), _mm_set_ps1(1./(1u<<25)), _mm_set_ps1(1./(1u<<26)), _mm_set_ps1(1./(1u<<27)),
-		_mm_set_ps1(1./(1u<<28)), _mm_set_ps1(1./(1u<<29)), _mm_set_ps1(1./(1u<<30)), _mm_set_ps1(1./(1u<<31)),
-	};
-
 	X64Reg coords = XMM0;
 
 	int elem_size = 1 << (format / 2);
@@ -348,9 +357,13 @@ void VertexLoaderX64::ReadColor(OpArg data, u64 attribute, int format)
 
 void VertexLoaderX64::GenerateVertexLoader()
 {
+	const bool load_pairs = cpu_info.bAVX2;
+
 	BitSet32 xmm_regs;
 	xmm_regs[XMM0+16] = true;
-	xmm_regs[XMM1+16] = !cpu_info.bSSSE3;
+	xmm_regs[XMM1+16] = !cpu_info.bSSSE3 || load_pairs;
+	xmm_regs[XMM2+16] = load_pairs;
+	xmm_regs[XMM3+16] = load_pairs;
 	ABI_PushRegistersAndAdjustStack(xmm_regs, 8);
 
 	// Backup count since we're going to count it down.
@@ -364,6 +377,12 @@ void VertexLoaderX64::GenerateVertexLoader()
 
 	// TODO: load constants into registers outside the main loop
 
+	// The pair loop needs to know the vertex size, so it is generated after
+	// the single vertex loop, which it falls back to for the last vertex.
+	FixupBranch to_pair_loop;
+	if (load_pairs)
+		to_pair_loop = J(true);
+
 	const u8* loop_start = GetCodePtr();
 
 	if (m_VtxDesc.PosMatIdx)
@@ -483,9 +502,14 @@ void VertexLoaderX64::GenerateVertexLoader()
 	ADD(64, R(src_reg), Imm32(m_src_ofs));
 
 	SUB(32, R(count_reg), Imm8(1));
-	J_CC(CC_NZ, loop_start);
+	FixupBranch next_pair;
+	if (load_pairs)
+		next_pair = J_CC(CC_NZ, true);
+	else
+		J_CC(CC_NZ, loop_start);
 
 	// Get the original count.
+	const u8* done = GetCodePtr();
 	POP(32, R(ABI_RETURN));
 
 	ABI_PopRegistersAndAdjustStack(xmm_regs, 8);
@@ -506,6 +530,319 @@ void VertexLoaderX64::GenerateVertexLoader()
 
 	m_VertexSize = m_src_ofs;
 	m_native_vtx_decl.stride = m_dst_ofs;
+
+	if (load_pairs)
+	{
+		SetJumpTarget(to_pair_loop);
+		SetJumpTarget(next_pair);
+		GenerateVertexPairLoop(loop_start, done);
+	}
+}
+
+// Gathers only pay off for attributes which don't fit into one load per vertex.
+static bool UseGather(u64 attribute, int load_bytes)
+{
+	return (attribute & MASK_INDEXED) && load_bytes > 8;
+}
+
+OpArg VertexLoaderX64::GetVertexPairAddr(int array, u64 attribute, int load_bytes, OpArg* data_b)
+{
+	if (!(attribute & MASK_INDEXED))
+	{
+		*data_b = MDisp(src_reg, m_src_ofs + m_VertexSize);
+		return MDisp(src_reg, m_src_ofs);
+	}
+
+	OpArg index_a = MDisp(src_reg, m_src_ofs);
+	OpArg index_b = MDisp(src_reg, m_src_ofs + m_VertexSize);
+	if (attribute == INDEX8)
+	{
+		MOVZX(32, 8, scratch1, index_a);
+		MOVZX(32, 8, scratch3, index_b);
+		m_src_ofs += 1;
+	}
+	else
+	{
+		MOVZX(32, 16, scratch1, index_a);
+		MOVZX(32, 16, scratch3, index_b);
+		m_src_ofs += 2;
+		BSWAP(16, scratch1);
+		BSWAP(16, scratch3);
+	}
+	IMUL(32, scratch1, M(&g_main_cp_state.array_strides[array]));
+	IMUL(32, scratch3, M(&g_main_cp_state.array_strides[array]));
+	MOV(64, R(scratch2), M(&cached_arraybases[array]));
+	if (!UseGather(attribute, load_bytes))
+	{
+		*data_b = MComplex(scratch2, scratch3, SCALE_1, 0);
+		return MComplex(scratch2, scratch1, SCALE_1, 0);
+	}
+
+	// Gather from base + (index * stride + 4 * dword) for both vertices.
+	VMOVD_xmm(XMM1, R(scratch1));
+	VMOVD_xmm(XMM2, R(scratch3));
+	VINSERTI128(YMM1, YMM1, R(XMM2), 1);
+	VPSHUFD(256, YMM1, R(YMM1), 0);
+	VPADDD(256, YMM1, YMM1, M(gather_offsets));
+	*data_b = MComplex(scratch2, XMM1, SCALE_1, 0);
+	return *data_b;
+}
+
+int VertexLoaderX64::ReadVertexPair(OpArg data, OpArg data_b, u64 attribute, int format, int count_in, int count_out, bool dequantize, u8 scaling_exponent, u32 dst_ofs)
+{
+	X64Reg coords = YMM0;
+	X64Reg temp = YMM2;
+
+	int elem_size = 1 << (format / 2);
+	int load_bytes = elem_size * count_in;
+	u32 stride = m_native_vtx_decl.stride;
+
+	if (UseGather(attribute, load_bytes))
+	{
+		// The masked out dwords are left alone, so clear them first.
+		VPXOR(coords, coords, R(coords));
+		VMOVDQU(256, temp, M(gather_masks[(load_bytes - 1) / 4]));
+		VPGATHERDD(256, coords, data, temp);
+	}
+	else
+	{
+		if (!(attribute & MASK_INDEXED))
+			m_src_ofs += load_bytes;
+
+		// Same loads as ReadVertex, so this doesn't read any further than the single vertex loop.
+		X64Reg regs[2] = { coords, temp };
+		OpArg srcs[2] = { data, data_b };
+		for (int i = 0; i < 2; i++)
+		{
+			if (load_bytes > 8)
+			{
+				VMOVQ_xmm(regs[i], srcs[i]);
+				srcs[i].AddMemOffset(8);
+				VPINSRD(regs[i], regs[i], srcs[i], 2);
+			}
+			else if (load_bytes > 4)
+			{
+				VMOVQ_xmm(regs[i], srcs[i]);
+			}
+			else
+			{
+				VMOVD_xmm(regs[i], srcs[i]);
+			}
+		}
+		VINSERTI128(coords, coords, R(temp), 1);
+	}
+
+	if (format == FORMAT_FLOAT)
+	{
+		VBROADCASTI128(temp, M(&bswap_shuffle));
+		VPSHUFB(256, coords, coords, R(temp));
+	}
+	else
+	{
+		VBROADCASTI128(temp, M(&shuffle_lut[format][count_in - 1]));
+		VPSHUFB(256, coords, coords, R(temp));
+
+		// Sign-extend.
+		if (format == FORMAT_BYTE)
+			VPSRAD(256, coords, coords, 24);
+		if (format == FORMAT_SHORT)
+			VPSRAD(256, coords, coords, 16);
+
+		VCVTDQ2PS(256, coords, R(coords));
+
+		if (dequantize && scaling_exponent)
+		{
+			VBROADCASTSS(256, temp, M(&scale_factors[scaling_exponent]));
+			VMULPS(256, coords, coords, R(temp));
+		}
+	}
+
+	OpArg dest = MDisp(dst_reg, dst_ofs);
+	for (int i = 0; i < 2; i++)
+	{
+		if (i)
+		{
+			VEXTRACTI128(R(coords), coords, 1);
+			dest.AddMemOffset(stride);
+		}
+		switch (count_out)
+		{
+		case 1: VMOVSS(dest, coords); break;
+		case 2: VMOVLPS(dest, coords); break;
+		case 3:
+			// The first vertex must not write into the second one.
+			if (dst_ofs + 16 <= stride)
+			{
+				VMOVUPS(dest, coords);
+			}
+			else
+			{
+				VMOVLPS(dest, coords);
+				dest.AddMemOffset(8);
+				VEXTRACTPS(dest, coords, 2);
+				dest.AddMemOffset(-8);
+			}
+			break;
+		}
+	}
+
+	return load_bytes;
+}
+
+void VertexLoaderX64::GenerateVertexPairLoop(const u8* single_vertex, const u8* done)
+{
+	const u32 stride = m_native_vtx_decl.stride;
+	m_src_ofs = 0;
+
+	CMP(32, R(count_reg), Imm8(2));
+	FixupBranch too_few = J_CC(CC_B, true);
+
+	const u8* loop_start = GetCodePtr();
+
+	u32 texmatidx_ofs[8];
+	const u64 tm[8] = {
+		m_VtxDesc.Tex0MatIdx, m_VtxDesc.Tex1MatIdx, m_VtxDesc.Tex2MatIdx, m_VtxDesc.Tex3MatIdx,
+		m_VtxDesc.Tex4MatIdx, m_VtxDesc.Tex5MatIdx, m_VtxDesc.Tex6MatIdx, m_VtxDesc.Tex7MatIdx,
+	};
+	u32 posmatidx_ofs = m_src_ofs;
+	if (m_VtxDesc.PosMatIdx)
+		m_src_ofs += sizeof(u8);
+	for (int i = 0; i < 8; i++)
+	{
+		if (tm[i])
+			texmatidx_ofs[i] = m_src_ofs++;
+	}
+
+	// Vertices which have to be skipped are left to the single vertex loop.
+	FixupBranch skip_vertex[2];
+	if (m_VtxDesc.Position & MASK_INDEXED)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			CMP(m_VtxDesc.Position == INDEX8 ? 8 : 16, MDisp(src_reg, m_src_ofs + i * m_VertexSize), Imm8(-1));
+			skip_vertex[i] = J_CC(CC_E, true);
+		}
+	}
+
+	if (m_VtxDesc.PosMatIdx)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			MOVZX(32, 8, scratch1, MDisp(src_reg, posmatidx_ofs + i * m_VertexSize));
+			AND(32, R(scratch1), Imm8(0x3F));
+			MOV(32, MDisp(dst_reg, m_native_vtx_decl.posmtx.offset + i * stride), R(scratch1));
+		}
+	}
+
+	OpArg data, data_b;
+	int pos_elements = 2 + m_VtxAttr.PosElements;
+	int pos_bytes = pos_elements << (m_VtxAttr.PosFormat / 2);
+	data = GetVertexPairAddr(ARRAY_POSITION, m_VtxDesc.Position, pos_bytes, &data_b);
+	ReadVertexPair(data, data_b, m_VtxDesc.Position, m_VtxAttr.PosFormat, pos_elements, pos_elements,
+	               m_VtxAttr.ByteDequant, m_VtxAttr.PosFrac, m_native_vtx_decl.position.offset);
+
+	if (m_VtxDesc.Normal)
+	{
+		static const u8 map[8] = { 7, 6, 15, 14 };
+		u8 scaling_exponent = map[m_VtxAttr.NormalFormat];
+
+		int elem_size = 1 << (m_VtxAttr.NormalFormat / 2);
+		for (int i = 0; i < (m_VtxAttr.NormalElements ? 3 : 1); i++)
+		{
+			if (!i || m_VtxAttr.NormalIndex3)
+			{
+				data = GetVertexPairAddr(ARRAY_NORMAL, m_VtxDesc.Normal, elem_size * 3, &data_b);
+				data.AddMemOffset(i * elem_size * 3);
+				data_b.AddMemOffset(i * elem_size * 3);
+			}
+			int load_bytes = ReadVertexPair(data, data_b, m_VtxDesc.Normal, m_VtxAttr.NormalFormat, 3, 3,
+			                                true, scaling_exponent, m_native_vtx_decl.normals[i].offset);
+			data.AddMemOffset(load_bytes);
+			data_b.AddMemOffset(load_bytes);
+		}
+	}
+
+	// Colors are converted in general purpose registers, one vertex at a time.
+	const u64 col[2] = { m_VtxDesc.Color0, m_VtxDesc.Color1 };
+	for (int i = 0; i < 2; i++)
+	{
+		if (!col[i])
+			continue;
+
+		// The second vertex first, so m_src_ofs ends up past the first one's index.
+		u32 src_ofs = m_src_ofs;
+		for (int j = 1; j >= 0; j--)
+		{
+			m_src_ofs = src_ofs + j * m_VertexSize;
+			m_dst_ofs = m_native_vtx_decl.colors[i].offset + j * stride;
+			data = GetVertexAddr(ARRAY_COLOR + i, col[i]);
+			ReadColor(data, col[i], m_VtxAttr.color[i].Comp);
+		}
+	}
+
+	const u64 tc[8] = {
+		m_VtxDesc.Tex0Coord, m_VtxDesc.Tex1Coord, m_VtxDesc.Tex2Coord, m_VtxDesc.Tex3Coord,
+		m_VtxDesc.Tex4Coord, m_VtxDesc.Tex5Coord, m_VtxDesc.Tex6Coord, m_VtxDesc.Tex7Coord,
+	};
+	for (int i = 0; i < 8; i++)
+	{
+		int elements = m_VtxAttr.texCoord[i].Elements + 1;
+		if (tc[i])
+		{
+			int load_bytes = elements << (m_VtxAttr.texCoord[i].Format / 2);
+			data = GetVertexPairAddr(ARRAY_TEXCOORD0 + i, tc[i], load_bytes, &data_b);
+			u8 scaling_exponent = m_VtxAttr.texCoord[i].Frac;
+			ReadVertexPair(data, data_b, tc[i], m_VtxAttr.texCoord[i].Format, elements, tm[i] ? 2 : elements,
+			               m_VtxAttr.ByteDequant, scaling_exponent, m_native_vtx_decl.texcoords[i].offset);
+		}
+		if (tm[i])
+		{
+			for (int j = 0; j < 2; j++)
+			{
+				OpArg dest = MDisp(dst_reg, m_native_vtx_decl.texcoords[i].offset + j * stride);
+				MOVZX(32, 8, scratch1, MDisp(src_reg, texmatidx_ofs[i] + j * m_VertexSize));
+				VCVTSI2SS(XMM0, XMM0, R(scratch1));
+				if (tc[i])
+				{
+					dest.AddMemOffset(2 * sizeof(float));
+				}
+				else
+				{
+					MOV(32, dest, Imm32(0));
+					dest.AddMemOffset(sizeof(float));
+					MOV(32, dest, Imm32(0));
+					dest.AddMemOffset(sizeof(float));
+				}
+				VMOVSS(dest, XMM0);
+			}
+		}
+	}
+
+	// Prepare for the next pair.
+	ADD(64, R(dst_reg), Imm32(2 * stride));
+	ADD(64, R(src_reg), Imm32(2 * m_VertexSize));
+
+	SUB(32, R(count_reg), Imm8(2));
+	CMP(32, R(count_reg), Imm8(2));
+	J_CC(CC_AE, loop_start);
+
+	// Avoid the AVX-SSE transition penalty in the single vertex loop.
+	SetJumpTarget(too_few);
+	VZEROUPPER();
+	TEST(32, R(count_reg), R(count_reg));
+	J_CC(CC_NZ, single_vertex);
+	JMP(done, true);
+
+	if (m_VtxDesc.Position & MASK_INDEXED)
+	{
+		SetJumpTarget(skip_vertex[0]);
+		SetJumpTarget(skip_vertex[1]);
+		VZEROUPPER();
+		JMP(single_vertex, true);
+	}
+
+	m_src_ofs = m_VertexSize;
+	m_dst_ofs = stride;
 }
 
 int VertexLoaderX64::RunVertices(DataReader src, DataReader dst, int count, int primitive)
@@ -19,4 +19,9 @@ private:
 	int ReadVertex(Gen::OpArg data, u64 attribute, int format, int count_in, int count_out, bool dequantize, u8 scaling_exponent, AttributeFormat* native_format);
 	void ReadColor(Gen::OpArg data, u64 attribute, int format);
 	void GenerateVertexLoader();
+
+	// AVX2 path, which loads two vertices per iteration, one in each 128-bit lane
+	Gen::OpArg GetVertexPairAddr(int array, u64 attribute, int load_bytes, Gen::OpArg* data_b);
+	int ReadVertexPair(Gen::OpArg data, Gen::OpArg data_b, u64 attribute, int format, int count_in, int count_out, bool dequantize, u8 scaling_exponent, u32 dst_ofs);
+	void GenerateVertexPairLoop(const u8* single_vertex, const u8* done);
 };
@@ -196,6 +196,19 @@ void VideoConfig::Load(const std::string& ini_file)
 	hacks->Get("EFBToTextureEnable", &bSkipEFBCopyToRam, true);
 	hacks->Get("EFBScaledCopy", &bCopyEFBScaled, true);
 	hacks->Get("EFBEmulateFormatChanges", &bEFBEmulateFormatChanges, false);
+	hacks->Get("BackgroundShaderCompiling", &bBackgroundShaderCompiling, false);
+	hacks->Get("ReuseVertexUploads", &bReuseVertexUploads, false);
+	hacks->Get("WatchTextureMemory", &bWatchTextureMemory, false);
+	hacks->Get("CacheDisplayListVertices", &bCacheDisplayListVertices, false);
+	hacks->Get("CompileDisplayLists", &bCompileDisplayLists, false);
+	hacks->Get("MultithreadedTextureDecoding", &bMultithreadedTextureDecoding, false);
+	hacks->Get("TextureDecodingThreshold", &iTextureDecodingThreshold, 256 * 256);
+	hacks->Get("GPUTextureDecoding", &bGPUTextureDecoding, false);
+	hacks->Get("DeferEFBCopies", &bDeferEFBCopies, false);
+	hacks->Get("AsyncEFBPeeks", &bAsyncEFBPeeks, false);
+	hacks->Get("EFBPeekLatency", &iEFBPeekLatency, 1);
+	hacks->Get("PerfQueryLatency", &iPerfQueryLatency, 0);
+	hacks->Get("BBoxMode", &iBBoxMode, (int)BBOX_ACCURATE);
 
 	LoadVR(File::GetUserPath(D_CONFIG_IDX) + "Dolphin.ini");
 
@@ -412,6 +425,19 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Hacks", "EFBToTextureEnable", bSkipEFBCopyToRam);
 	CHECK_SETTING("Video_Hacks", "EFBScaledCopy", bCopyEFBScaled);
 	CHECK_SETTING("Video_Hacks", "EFBEmulateFormatChanges", bEFBEmulateFormatChanges);
+	CHECK_SETTING("Video_Hacks", "BackgroundShaderCompiling", bBackgroundShaderCompiling);
+	CHECK_SETTING("Video_Hacks", "ReuseVertexUploads", bReuseVertexUploads);
+	CHECK_SETTING("Video_Hacks", "WatchTextureMemory", bWatchTextureMemory);
+	CHECK_SETTING("Video_Hacks", "CacheDisplayListVertices", bCacheDisplayListVertices);
+	CHECK_SETTING("Video_Hacks", "CompileDisplayLists", bCompileDisplayLists);
+	CHECK_SETTING("Video_Hacks", "MultithreadedTextureDecoding", bMultithreadedTextureDecoding);
+	CHECK_SETTING("Video_Hacks", "TextureDecodingThreshold", iTextureDecodingThreshold);
+	CHECK_SETTING("Video_Hacks", "GPUTextureDecoding", bGPUTextureDecoding);
+	CHECK_SETTING("Video_Hacks", "DeferEFBCopies", bDeferEFBCopies);
+	CHECK_SETTING("Video_Hacks", "AsyncEFBPeeks", bAsyncEFBPeeks);
+	CHECK_SETTING("Video_Hacks", "EFBPeekLatency", iEFBPeekLatency);
+	CHECK_SETTING("Video_Hacks", "PerfQueryLatency", iPerfQueryLatency);
+	CHECK_SETTING("Video_Hacks", "BBoxMode", iBBoxMode);
 	if (g_has_hmd)
 	{
 		CHECK_SETTING("Video_Hacks_VR", "EFBAccessEnable", bEFBAccessEnable);
@@ -656,6 +682,19 @@ void VideoConfig::Save(const std::string& ini_file)
 	hacks->Set("EFBToTextureEnable", bSkipEFBCopyToRam);
 	hacks->Set("EFBScaledCopy", bCopyEFBScaled);
 	hacks->Set("EFBEmulateFormatChanges", bEFBEmulateFormatChanges);
+	hacks->Set("BackgroundShaderCompiling", bBackgroundShaderCompiling);
+	hacks->Set("ReuseVertexUploads", bReuseVertexUploads);
+	hacks->Set("WatchTextureMemory", bWatchTextureMemory);
+	hacks->Set("CacheDisplayListVertices", bCacheDisplayListVertices);
+	hacks->Set("CompileDisplayLists", bCompileDisplayLists);
+	hacks->Set("MultithreadedTextureDecoding", bMultithreadedTextureDecoding);
+	hacks->Set("TextureDecodingThreshold", iTextureDecodingThreshold);
+	hacks->Set("GPUTextureDecoding", bGPUTextureDecoding);
+	hacks->Set("DeferEFBCopies", bDeferEFBCopies);
+	hacks->Set("AsyncEFBPeeks", bAsyncEFBPeeks);
+	hacks->Set("EFBPeekLatency", iEFBPeekLatency);
+	hacks->Set("PerfQueryLatency", iPerfQueryLatency);
+	hacks->Set("BBoxMode", iBBoxMode);
 
 	SaveVR(File::GetUserPath(D_CONFIG_IDX) + "Dolphin.ini");
 	iniFile.Save(ini_file);
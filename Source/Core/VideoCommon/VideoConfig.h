@@ -55,6 +55,13 @@ enum StereoMode
 	STEREO_VR920,
 };
 
+enum BBoxMode
+{
+	BBOX_ACCURATE = 0, // read back from the GPU whenever the game reads it
+	BBOX_ASYNC,        // newest finished GPU readback, CPU estimate until there is one
+	BBOX_ESTIMATE,     // estimated on the CPU from the transformed vertices
+};
+
 enum TGameCamera
 {
 	CAMERA_YAWPITCHROLL = 0,
@@ -127,6 +134,7 @@ struct VideoConfig final
 	// Hacks
 	bool bEFBAccessEnable;
 	bool bPerfQueriesEnable;
+	int iPerfQueryLatency; // in frames, 0 waits for the GPU
 
 	bool bEFBCopyEnable;
 	bool bEFBCopyClearDisable;
@@ -139,6 +147,18 @@ struct VideoConfig final
 	float fAspectRatioHackW, fAspectRatioHackH;
 	bool bEnablePixelLighting;
 	bool bFastDepthCalc;
+	bool bBackgroundShaderCompiling;
+	bool bReuseVertexUploads;
+	bool bWatchTextureMemory;
+	bool bCacheDisplayListVertices;
+	bool bCompileDisplayLists;
+	bool bMultithreadedTextureDecoding;
+	int iTextureDecodingThreshold; // in texels
+	bool bGPUTextureDecoding;
+	bool bDeferEFBCopies;
+	bool bAsyncEFBPeeks;
+	int iEFBPeekLatency; // in frames
+	int iBBoxMode; // BBoxMode
 	int iLog; // CONF_ bits
 	int iSaveTargetId; // TODO: Should be dropped
 
@@ -274,6 +294,7 @@ struct VideoConfig final
 		bool bSupportsGSInstancing; // Needed by GeometryShaderGen, so must stay in VideoCommon
 		bool bSupportsPostProcessing;
 		bool bSupportsPaletteConversion;
+		bool bSupportsGPUTextureDecoding;
 	} backend_info;
 
 	// Utility
@@ -281,6 +302,7 @@ struct VideoConfig final
 	bool VirtualXFBEnabled() const { return bUseXFB && !bUseRealXFB; }
 	bool EFBCopiesToTextureEnabled() const { return bEFBCopyEnable && bSkipEFBCopyToRam; }
 	bool EFBCopiesToRamEnabled() const { return bEFBCopyEnable && !bSkipEFBCopyToRam; }
+	bool GPUBBoxEnabled() const { return backend_info.bSupportsBBox && iBBoxMode != BBOX_ESTIMATE; }
 	bool ExclusiveFullscreenEnabled() const { return backend_info.bSupportsExclusiveFullscreen && !bBorderlessFullscreen; }
 };
 
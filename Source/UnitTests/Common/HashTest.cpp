@@ -0,0 +1,125 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/Hash.h"
+#include "Common/Intrinsics.h"
+
+typedef u64 (*HashFunction)(const u8* src, u32 len, u32 samples);
+
+static std::vector<u8> MakeTestData(size_t size)
+{
+	std::vector<u8> data(size);
+	u32 x = 0x12345678;
+	for (u8& byte : data)
+	{
+		x = x * 1664525 + 1013904223;
+		byte = (u8)(x >> 24);
+	}
+	return data;
+}
+
+static void CheckSensitivity(HashFunction hash)
+{
+	std::vector<u8> data = MakeTestData(4096 + 37);
+	for (u32 len : { 1u, 7u, 63u, 64u, 65u, 200u, 1024u, 4096u + 37u })
+	{
+		const u64 reference = hash(data.data(), len, 0);
+		EXPECT_EQ(reference, hash(data.data(), len, 0));
+
+		for (u32 i = 0; i < len; i += std::max(len / 61, 1u))
+		{
+			data[i] ^= 0x10;
+			EXPECT_NE(reference, hash(data.data(), len, 0)) << "len " << len << ", byte " << i;
+			data[i] ^= 0x10;
+		}
+	}
+}
+
+TEST(Hash, MurmurHash3)
+{
+	CheckSensitivity(&GetMurmurHash3);
+}
+
+#if defined(_M_X86) && _ARCH_64
+TEST(Hash, AVX2Hash)
+{
+	if (!cpu_info.bAVX2)
+		return;
+
+	CheckSensitivity(&GetAVX2Hash);
+
+	// Swapping two stripes must change the hash.
+	std::vector<u8> data = MakeTestData(4096);
+	std::vector<u8> swapped = data;
+	std::swap_ranges(swapped.begin(), swapped.begin() + 64, swapped.begin() + 64);
+	EXPECT_NE(GetAVX2Hash(data.data(), 4096, 0), GetAVX2Hash(swapped.data(), 4096, 0));
+
+	// The length is part of the hash, even if the data is all zeroes.
+	std::vector<u8> zeroes(256);
+	EXPECT_NE(GetAVX2Hash(zeroes.data(), 128, 0), GetAVX2Hash(zeroes.data(), 256, 0));
+
+	// Sampling only reads the sampled stripes: 32 samples of 8 bytes are four
+	// of the 64 stripes.
+	const u64 sampled = GetAVX2Hash(data.data(), 4096, 32);
+	data[64 * 1] ^= 1;
+	EXPECT_EQ(sampled, GetAVX2Hash(data.data(), 4096, 32));
+	data[64 * 16] ^= 1;
+	EXPECT_NE(sampled, GetAVX2Hash(data.data(), 4096, 32));
+}
+#endif
+
+// Throughput over typical texture sizes. Run with --gtest_also_run_disabled_tests.
+TEST(Hash, DISABLED_Benchmark)
+{
+	struct Function
+	{
+		const char* name;
+		HashFunction hash;
+		bool supported;
+	};
+	const Function functions[] = {
+		{ "MurmurHash3", &GetMurmurHash3, true },
+#if _M_SSE >= 0x402
+		{ "CRC32", &GetCRC32, cpu_info.bSSE4_2 },
+#endif
+#if defined(_M_X86) && _ARCH_64
+		{ "AVX2", &GetAVX2Hash, cpu_info.bAVX2 },
+#endif
+	};
+
+	// 64x64 I8, 128x128 RGB565, 512x512 CMPR, 512x512 RGBA8, 1024x1024 RGBA8
+	const u32 sizes[] = { 4096, 32768, 131072, 1048576, 4194304 };
+	std::vector<u8> data = MakeTestData(sizes[4]);
+
+	for (const Function& f : functions)
+	{
+		if (!f.supported)
+			continue;
+
+		for (u32 size : sizes)
+		{
+			for (u32 samples : { 0u, 128u })
+			{
+				const u32 iterations = std::max(256u * 1024 * 1024 / size, 16u);
+				u64 sink = 0;
+				auto start = std::chrono::high_resolution_clock::now();
+				for (u32 i = 0; i < iterations; i++)
+					sink += f.hash(data.data(), size, samples);
+				auto end = std::chrono::high_resolution_clock::now();
+
+				double seconds = std::chrono::duration<double>(end - start).count();
+				printf("%-12s %8u bytes, %3u samples: %8.0f ns/hash, %6.2f GB/s (%016llx)\n",
+				       f.name, size, samples, seconds * 1e9 / iterations,
+				       (double)size * iterations / seconds / 1e9, (unsigned long long)sink);
+			}
+		}
+	}
+}
@@ -1021,6 +1021,57 @@ AVX_RRM_TEST(VPANDN,  "dqword")
 AVX_RRM_TEST(VPOR,    "dqword")
 AVX_RRM_TEST(VPXOR,   "dqword")
 
+// for AVX instructions with a vector size that take the form op reg, reg, r/m
+#define AVX_RRM_BITS_TEST(Name, bits, sizename, regnames) \
+	TEST_F(x64EmitterTest, Name ## _ ## bits) \
+	{ \
+		const std::string out_name = regnames[0].name; \
+		for (const auto& r : regnames) \
+		{ \
+			emitter->Name(bits, r.reg, XMM0, R(XMM0)); \
+			emitter->Name(bits, XMM0, XMM0, R(r.reg)); \
+			emitter->Name(bits, XMM0, r.reg, MatR(R12)); \
+			ExpectDisassembly(#Name " " + r.name + ", " + out_name + ", " + out_name + " " \
+			                  #Name " " + out_name + ", " + out_name + ", " + r.name + " " \
+			                  #Name " " + out_name + ", " + r.name + ", " sizename " ptr ds:[r12] "); \
+		} \
+	}
+
+AVX_RRM_BITS_TEST(VMULPS,  128, "dqword", xmmnames)
+AVX_RRM_BITS_TEST(VMULPS,  256, "qqword", ymmnames)
+AVX_RRM_BITS_TEST(VPADDD,  128, "dqword", xmmnames)
+AVX_RRM_BITS_TEST(VPADDD,  256, "qqword", ymmnames)
+AVX_RRM_BITS_TEST(VPSHUFB, 128, "dqword", xmmnames)
+AVX_RRM_BITS_TEST(VPSHUFB, 256, "qqword", ymmnames)
+
+TEST_F(x64EmitterTest, VZEROUPPER)
+{
+	emitter->VZEROUPPER();
+	ExpectDisassembly("vzeroupper");
+}
+
+TEST_F(x64EmitterTest, VCVTDQ2PS)
+{
+	emitter->VCVTDQ2PS(128, XMM1, R(XMM9));
+	emitter->VCVTDQ2PS(256, YMM9, MatR(R12));
+	ExpectDisassembly("vcvtdq2ps xmm1, xmm9 "
+	                  "vcvtdq2ps ymm9, qqword ptr ds:[r12]");
+}
+
+TEST_F(x64EmitterTest, VPSHUFD)
+{
+	emitter->VPSHUFD(256, YMM1, R(YMM9), 0x1B);
+	ExpectDisassembly("vpshufd ymm1, ymm9, 0x1b");
+}
+
+TEST_F(x64EmitterTest, VPSRAD)
+{
+	emitter->VPSRAD(256, YMM1, YMM9, 16);
+	emitter->VPSRAD(128, XMM9, XMM1, 24);
+	ExpectDisassembly("vpsrad ymm1, ymm9, 0x10 "
+	                  "vpsrad xmm9, xmm1, 0x18");
+}
+
 #define FMA_TEST(Name, P, packed) \
 	AVX_RRM_TEST(Name ## 132 ## P ## S, packed ? "dqword" : "dword") \
 	AVX_RRM_TEST(Name ## 213 ## P ## S, packed ? "dqword" : "dword") \
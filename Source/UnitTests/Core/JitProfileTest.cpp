@@ -0,0 +1,140 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <initializer_list>
+#include <set>
+#include <string>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/PowerPC/JitCommon/JitProfile.h"
+
+static std::set<u32> s_loaded_addresses;
+
+static bool IsLoaded(u32 address, u32 first_instruction)
+{
+	return s_loaded_addresses.count(address) != 0;
+}
+
+static bool IsAlwaysLoaded(u32 address, u32 first_instruction)
+{
+	return true;
+}
+
+class JitProfileTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		m_cache_dir = File::GetCurrentDir() + DIR_SEP "JitProfileTest" DIR_SEP;
+		File::SetUserPath(D_CACHE_IDX, m_cache_dir);
+		s_loaded_addresses.clear();
+	}
+
+	void TearDown() override
+	{
+		File::DeleteDirRecursively(m_cache_dir);
+	}
+
+	// Records blocks at 0x80000000, 0x80000100, ... with the given run counts
+	// and reloads the profile from disk.
+	void SaveAndLoad(const std::initializer_list<u64>& run_counts)
+	{
+		JitProfile profile;
+		profile.Init("TEST01");
+		u32 address = 0x80000000;
+		for (u64 run_count : run_counts)
+		{
+			profile.RecordBlock(address, address + 1, address + 2, JitProfile::GetMSRBits(), run_count);
+			address += 0x100;
+		}
+		profile.Shutdown();
+
+		m_profile.Init("TEST01");
+	}
+
+	std::string m_cache_dir;
+	JitProfile m_profile;
+};
+
+TEST_F(JitProfileTest, LoadsSavedBlocksHottestFirst)
+{
+	SaveAndLoad({ 100, 10, 1000, 500 });
+
+	u32 address, hash;
+	ASSERT_TRUE(m_profile.GetNextPendingBlock(&address, &hash, IsAlwaysLoaded));
+	EXPECT_EQ(0x80000200u, address);
+	EXPECT_EQ(0x80000202u, hash);
+	m_profile.RemovePendingBlock();
+	ASSERT_TRUE(m_profile.GetNextPendingBlock(&address, &hash, IsAlwaysLoaded));
+	EXPECT_EQ(0x80000300u, address);
+	m_profile.RemovePendingBlock();
+	ASSERT_TRUE(m_profile.GetNextPendingBlock(&address, &hash, IsAlwaysLoaded));
+	EXPECT_EQ(0x80000000u, address);
+	m_profile.RemovePendingBlock();
+
+	// Blocks which ran only a few times aren't saved
+	EXPECT_FALSE(m_profile.HasPendingBlocks());
+	EXPECT_FALSE(m_profile.GetNextPendingBlock(&address, &hash, IsAlwaysLoaded));
+}
+
+TEST_F(JitProfileTest, OldSessionsCountLess)
+{
+	SaveAndLoad({ 100, 1000 });
+	// Halved to 50 on load, so the first block doesn't survive another session
+	m_profile.Shutdown();
+	m_profile.Init("TEST01");
+
+	u32 address, hash;
+	ASSERT_TRUE(m_profile.GetNextPendingBlock(&address, &hash, IsAlwaysLoaded));
+	EXPECT_EQ(0x80000100u, address);
+	m_profile.RemovePendingBlock();
+	EXPECT_FALSE(m_profile.HasPendingBlocks());
+}
+
+TEST_F(JitProfileTest, IgnoresCorruptProfile)
+{
+	File::CreateFullPath(m_cache_dir + "JitProfile" DIR_SEP);
+	File::WriteStringToFile("garbage", m_cache_dir + "JitProfile" DIR_SEP "TEST01.prof");
+
+	m_profile.Init("TEST01");
+	EXPECT_FALSE(m_profile.HasPendingBlocks());
+}
+
+TEST_F(JitProfileTest, SkipsBlocksThatArentLoaded)
+{
+	SaveAndLoad({ 400, 300, 200, 100 });
+
+	u32 address, hash;
+	EXPECT_FALSE(m_profile.GetNextPendingBlock(&address, &hash, IsLoaded));
+
+	s_loaded_addresses.insert(0x80000100);
+	s_loaded_addresses.insert(0x80000300);
+	ASSERT_TRUE(m_profile.GetNextPendingBlock(&address, &hash, IsLoaded));
+	EXPECT_EQ(0x80000100u, address);
+	ASSERT_TRUE(m_profile.GetNextPendingBlock(&address, &hash, IsLoaded));
+	EXPECT_EQ(0x80000300u, address);
+	m_profile.RemovePendingBlock();
+
+	// The block that wasn't removed comes up again
+	ASSERT_TRUE(m_profile.GetNextPendingBlock(&address, &hash, IsLoaded));
+	EXPECT_EQ(0x80000100u, address);
+	m_profile.RemovePendingBlock();
+	// Removing twice doesn't remove another block
+	m_profile.RemovePendingBlock();
+
+	// The search continues after the last returned block
+	s_loaded_addresses.insert(0x80000000);
+	s_loaded_addresses.insert(0x80000200);
+	ASSERT_TRUE(m_profile.GetNextPendingBlock(&address, &hash, IsLoaded));
+	EXPECT_EQ(0x80000200u, address);
+	m_profile.RemovePendingBlock();
+	ASSERT_TRUE(m_profile.GetNextPendingBlock(&address, &hash, IsLoaded));
+	EXPECT_EQ(0x80000000u, address);
+	m_profile.RemovePendingBlock();
+	EXPECT_FALSE(m_profile.HasPendingBlocks());
+}
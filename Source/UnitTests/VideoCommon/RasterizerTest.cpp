@@ -0,0 +1,148 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoBackends/Software/SWVideoConfig.h"
+#include "VideoCommon/BPMemory.h"
+
+static const size_t EFB_SIZE = EFB_WIDTH * EFB_HEIGHT * 6;
+
+class RasterizerTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		memset(&bpmem, 0, sizeof(bpmem));
+
+		// Full EFB scissor
+		bpmem.scissorOffset.x = 342 / 2;
+		bpmem.scissorOffset.y = 342 / 2;
+		bpmem.scissorTL.x = 342;
+		bpmem.scissorTL.y = 342;
+		bpmem.scissorBR.x = 341 + EFB_WIDTH;
+		bpmem.scissorBR.y = 341 + EFB_HEIGHT;
+
+		// Two TEV stages fed by the rasterized color, which only write registers
+		// before reading them, so triangles can be split up between threads.
+		bpmem.genMode.numcolchans = 1;
+		bpmem.genMode.numtevstages = 1;
+		bpmem.tevksel[0].swap1 = 0;
+		bpmem.tevksel[0].swap2 = 1;
+		bpmem.tevksel[1].swap1 = 2;
+		bpmem.tevksel[1].swap2 = 3;
+
+		TevStageCombiner::ColorCombiner& cc0 = bpmem.combiners[0].colorC;
+		cc0.a = 15; // zero
+		cc0.b = 10; // rasterized color
+		cc0.c = 13; // one half
+		cc0.d = 4; // C1
+		cc0.dest = 1; // C0
+		TevStageCombiner::AlphaCombiner& ac0 = bpmem.combiners[0].alphaC;
+		ac0.a = 7; // zero
+		ac0.b = 5; // rasterized alpha
+		ac0.c = 6; // konst
+		ac0.d = 7; // zero
+		ac0.dest = 1; // A0
+
+		TevStageCombiner::ColorCombiner& cc1 = bpmem.combiners[1].colorC;
+		cc1.a = 2; // C0
+		cc1.b = 10; // rasterized color
+		cc1.c = 11; // rasterized alpha
+		cc1.d = 15; // zero
+		cc1.clamp = 1;
+		TevStageCombiner::AlphaCombiner& ac1 = bpmem.combiners[1].alphaC;
+		ac1.a = 7; // zero
+		ac1.b = 7; // zero
+		ac1.c = 7; // zero
+		ac1.d = 1; // A0
+		ac1.clamp = 1;
+
+		bpmem.alpha_test.comp0 = AlphaTest::ALWAYS;
+		bpmem.alpha_test.comp1 = AlphaTest::ALWAYS;
+
+		// Blending and depth testing make the result depend on the drawing order
+		bpmem.zcontrol.pixel_format = PEControl::RGBA6_Z24;
+		bpmem.zmode.testenable = 1;
+		bpmem.zmode.func = ZMode::LEQUAL;
+		bpmem.zmode.updateenable = 1;
+		bpmem.blendmode.blendenable = 1;
+		bpmem.blendmode.srcfactor = BlendMode::SRCALPHA;
+		bpmem.blendmode.dstfactor = BlendMode::INVSRCALPHA;
+		bpmem.blendmode.colorupdate = 1;
+		bpmem.blendmode.alphaupdate = 1;
+	}
+
+	void TearDown() override
+	{
+		Rasterizer::Shutdown();
+	}
+
+	// Draws random triangles into a cleared EFB and returns its contents.
+	std::vector<u8> DrawTriangles(u32 threads)
+	{
+		g_SWVideoConfig.rasterizerThreads = threads;
+		Rasterizer::Init();
+		Rasterizer::SetScissor();
+		for (int comp = 0; comp < 4; comp++)
+			Rasterizer::SetTevReg(2, comp, false, 16 + 32 * comp);
+
+		u8* efb = EfbInterface::GetPixelPointer(0, 0, false);
+		memset(efb, 0, EfbInterface::DEPTH_BUFFER_START);
+		memset(efb + EfbInterface::DEPTH_BUFFER_START, 0xFF, EFB_SIZE - EfbInterface::DEPTH_BUFFER_START);
+
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> x_coord(-64.0f, EFB_WIDTH + 64.0f);
+		std::uniform_real_distribution<float> y_coord(-64.0f, EFB_HEIGHT + 64.0f);
+		std::uniform_real_distribution<float> z_coord(0.0f, 16777215.0f);
+		std::uniform_real_distribution<float> w_coord(0.5f, 2.0f);
+		std::uniform_int_distribution<int> color(0, 255);
+
+		for (int i = 0; i < 40; i++)
+		{
+			OutputVertexData v[3];
+			for (OutputVertexData& vertex : v)
+			{
+				memset(&vertex, 0, sizeof(vertex));
+				vertex.screenPosition.x = x_coord(rng);
+				vertex.screenPosition.y = y_coord(rng);
+				vertex.screenPosition.z = z_coord(rng);
+				vertex.projectedPosition.w = w_coord(rng);
+				for (int comp = 0; comp < 4; comp++)
+					vertex.color[0][comp] = color(rng);
+			}
+
+			// Only front faces are drawn, so draw both windings
+			Rasterizer::DrawTriangleFrontFace(&v[0], &v[1], &v[2]);
+			Rasterizer::DrawTriangleFrontFace(&v[0], &v[2], &v[1]);
+		}
+
+		return std::vector<u8>(efb, efb + EFB_SIZE);
+	}
+};
+
+TEST_F(RasterizerTest, ThreadedDrawMatchesSingleThreaded)
+{
+	std::vector<u8> expected = DrawTriangles(1);
+	ASSERT_TRUE(std::any_of(expected.begin(), expected.begin() + EfbInterface::DEPTH_BUFFER_START,
+		[](u8 value) { return value != 0; }));
+
+	for (u32 threads : { 2, 3, 4, 8 })
+	{
+		std::vector<u8> actual = DrawTriangles(threads);
+		auto mismatch = std::mismatch(expected.begin(), expected.end(), actual.begin());
+		EXPECT_TRUE(mismatch.first == expected.end())
+			<< threads << " threads, first difference at EFB byte " << (mismatch.first - expected.begin());
+	}
+}
@@ -0,0 +1,65 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/TextureDecoder.h"
+
+class TextureDecoderTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		// Split every texture that is large enough to be split at all.
+		TexDecoder_SetThreadingOptions(1);
+	}
+
+	void TearDown() override
+	{
+		TexDecoder_Shutdown();
+	}
+
+	void ExpectSameAsSingleThreaded(int width, int height, int texformat)
+	{
+		std::mt19937 rng(width * 65536 + height * 256 + texformat);
+		std::uniform_int_distribution<int> byte(0, 255);
+
+		std::vector<u8> src(TexDecoder_GetTextureSizeInBytes(width, height, texformat));
+		for (u8& b : src)
+			b = byte(rng);
+		// Big enough for C14X2
+		std::vector<u8> tlut(16384 * 2);
+		for (u8& b : tlut)
+			b = byte(rng);
+
+		std::vector<u8> expected(width * height * 4, 0);
+		std::vector<u8> actual(width * height * 4, 0);
+		_TexDecoder_DecodeImpl((u32*)expected.data(), src.data(), width, height, texformat, tlut.data(), GX_TL_RGB5A3);
+		TexDecoder_Decode(actual.data(), src.data(), width, height, texformat, tlut.data(), GX_TL_RGB5A3);
+
+		EXPECT_EQ(expected, actual) << "format " << texformat << ", " << width << "x" << height;
+	}
+};
+
+TEST_F(TextureDecoderTest, ThreadedDecodeMatchesSingleThreaded)
+{
+	static const int formats[] = {
+		GX_TF_I4, GX_TF_I8, GX_TF_IA4, GX_TF_IA8, GX_TF_RGB565, GX_TF_RGB5A3,
+		GX_TF_RGBA8, GX_TF_C4, GX_TF_C8, GX_TF_C14X2, GX_TF_CMPR,
+	};
+	// Includes heights that don't split evenly into the decoding threads.
+	static const int sizes[][2] = {
+		{ 8, 8 }, { 64, 64 }, { 256, 24 }, { 128, 200 }, { 640, 528 },
+	};
+
+	for (int texformat : formats)
+	{
+		for (const auto& size : sizes)
+			ExpectSameAsSingleThreaded(size[0], size[1], texformat);
+	}
+}
@@ -1,12 +1,16 @@
+#include <chrono>
+#include <cstdio>
 #include <limits>
 #include <memory>
 #include <tuple>
 #include <type_traits>
 #include <unordered_set>
+#include <vector>
 
 #include <gtest/gtest.h>  // NOLINT
 
 #include "Common/Common.h"
+#include "Common/CPUDetect.h"
 #include "Common/MathUtil.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
@@ -93,6 +97,47 @@ protected:
 		m_dst = DataReader(output_memory, output_memory + sizeof(output_memory));
 	}
 
+	// Points all arrays at the input and fills it with bytes which are never
+	// 0xFF, so indices are spread out but never skip the vertex.
+	void FillInput(u32 array_stride)
+	{
+		for (size_t i = 0; i < sizeof(input_memory); i++)
+			input_memory[i] = (u8)(i * 7 % 251);
+		for (int i = 0; i < 16; i++)
+		{
+			cached_arraybases[i] = input_memory;
+			g_main_cp_state.array_strides[i] = array_stride;
+		}
+	}
+
+	// Runs the vertex loader with and without the AVX2 path and prints the
+	// throughput of each.
+	void Benchmark(int count, int iterations)
+	{
+		const bool has_avx2 = cpu_info.bAVX2;
+		for (bool avx2 : { false, true })
+		{
+			if (avx2 && !has_avx2)
+				continue;
+
+			cpu_info.bAVX2 = avx2;
+			m_loader.reset(VertexLoaderBase::CreateVertexLoader(m_vtx_desc, m_vtx_attr));
+			RunVertices(count); // warm up the caches
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < iterations; ++i)
+				RunVertices(count);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			double seconds = std::chrono::duration<double>(end - start).count();
+			double vertices = (double)count * iterations;
+			printf("%-4s %6.2f ns/vertex, %7.1f Mvertices/s, %6.2f GB/s written\n",
+			       avx2 ? "AVX2" : "SSE", seconds * 1e9 / vertices, vertices / seconds / 1e6,
+			       vertices * m_loader->m_native_vtx_decl.stride / seconds / 1e9);
+		}
+		cpu_info.bAVX2 = has_avx2;
+	}
+
 	DataReader m_src;
 	DataReader m_dst;
 
@@ -218,8 +263,7 @@ TEST_P(VertexLoaderSpeedTest, PositionDirectAll)
 	elements += 2;
 	size_t elem_size = 1 << (format / 2);
 	CreateAndCheckSizes(elements * elem_size, elements * sizeof(float));
-	for (int i = 0; i < 1000; ++i)
-		RunVertices(100000);
+	Benchmark(100000, 1000);
 }
 
 TEST_P(VertexLoaderSpeedTest, TexCoordSingleElement)
@@ -237,8 +281,7 @@ TEST_P(VertexLoaderSpeedTest, TexCoordSingleElement)
 	size_t elem_size = 1 << (format / 2);
 	CreateAndCheckSizes(2 * sizeof(s8)    + elements * elem_size,
 	                    2 * sizeof(float) + elements * sizeof(float));
-	for (int i = 0; i < 1000; ++i)
-		RunVertices(100000);
+	Benchmark(100000, 1000);
 }
 
 TEST_F(VertexLoaderTest, LargeFloatVertexSpeed)
@@ -301,6 +344,141 @@ TEST_F(VertexLoaderTest, LargeFloatVertexSpeed)
 
 	// This test is only done 100x in a row since it's ~20x slower using the
 	// current vertex loader implementation.
-	for (int i = 0; i < 100; ++i)
-		RunVertices(100000);
+	Benchmark(100000, 100);
+}
+
+// Layouts which games commonly use, for benchmarking the vertex loader paths
+// against each other.
+enum TypicalLayout
+{
+	LAYOUT_DIRECT_S16_POSITION,
+	LAYOUT_DIRECT_FLOAT,
+	LAYOUT_INDEXED_FLOAT,
+	LAYOUT_INDEXED_S16,
+	LAYOUT_INDEXED_SKINNED,
+	NUM_TYPICAL_LAYOUTS,
+};
+
+class VertexLoaderLayoutTest : public VertexLoaderTest, public ::testing::WithParamInterface<int>
+{
+protected:
+	void SetLayout(int layout)
+	{
+		switch (layout)
+		{
+		case LAYOUT_DIRECT_S16_POSITION:
+			m_vtx_desc.Position = DIRECT;
+			m_vtx_attr.g0.PosElements = 1;
+			m_vtx_attr.g0.PosFormat = FORMAT_SHORT;
+			m_vtx_attr.g0.PosFrac = 8;
+			break;
+		case LAYOUT_DIRECT_FLOAT:
+			m_vtx_desc.Position = DIRECT;
+			m_vtx_desc.Normal = DIRECT;
+			m_vtx_desc.Color0 = DIRECT;
+			m_vtx_desc.Tex0Coord = DIRECT;
+			m_vtx_attr.g0.PosElements = 1;
+			m_vtx_attr.g0.PosFormat = FORMAT_FLOAT;
+			m_vtx_attr.g0.NormalFormat = FORMAT_BYTE;
+			m_vtx_attr.g0.Color0Elements = 1;
+			m_vtx_attr.g0.Color0Comp = FORMAT_32B_8888;
+			m_vtx_attr.g0.Tex0CoordElements = 1;
+			m_vtx_attr.g0.Tex0CoordFormat = FORMAT_FLOAT;
+			break;
+		case LAYOUT_INDEXED_FLOAT:
+			m_vtx_desc.Position = INDEX16;
+			m_vtx_desc.Normal = INDEX16;
+			m_vtx_desc.Color0 = INDEX16;
+			m_vtx_desc.Tex0Coord = INDEX16;
+			m_vtx_attr.g0.PosElements = 1;
+			m_vtx_attr.g0.PosFormat = FORMAT_FLOAT;
+			m_vtx_attr.g0.NormalFormat = FORMAT_FLOAT;
+			m_vtx_attr.g0.Color0Elements = 1;
+			m_vtx_attr.g0.Color0Comp = FORMAT_32B_8888;
+			m_vtx_attr.g0.Tex0CoordElements = 1;
+			m_vtx_attr.g0.Tex0CoordFormat = FORMAT_FLOAT;
+			break;
+		case LAYOUT_INDEXED_S16:
+			m_vtx_desc.Position = INDEX16;
+			m_vtx_desc.Normal = INDEX8;
+			m_vtx_desc.Tex0Coord = INDEX16;
+			m_vtx_desc.Tex1Coord = INDEX16;
+			m_vtx_attr.g0.PosElements = 1;
+			m_vtx_attr.g0.PosFormat = FORMAT_SHORT;
+			m_vtx_attr.g0.PosFrac = 6;
+			m_vtx_attr.g0.NormalFormat = FORMAT_BYTE;
+			m_vtx_attr.g0.Tex0CoordElements = 1;
+			m_vtx_attr.g0.Tex0CoordFormat = FORMAT_SHORT;
+			m_vtx_attr.g0.Tex0Frac = 10;
+			m_vtx_attr.g1.Tex1CoordElements = 1;
+			m_vtx_attr.g1.Tex1CoordFormat = FORMAT_USHORT;
+			m_vtx_attr.g1.Tex1Frac = 12;
+			break;
+		case LAYOUT_INDEXED_SKINNED:
+			m_vtx_desc.PosMatIdx = 1;
+			m_vtx_desc.Tex0MatIdx = 1;
+			m_vtx_desc.Position = INDEX16;
+			m_vtx_desc.Normal = INDEX16;
+			m_vtx_desc.Color0 = INDEX8;
+			m_vtx_desc.Tex0Coord = INDEX16;
+			m_vtx_attr.g0.PosElements = 1;
+			m_vtx_attr.g0.PosFormat = FORMAT_FLOAT;
+			m_vtx_attr.g0.NormalElements = 1;
+			m_vtx_attr.g0.NormalFormat = FORMAT_SHORT;
+			m_vtx_attr.g0.Color0Elements = 1;
+			m_vtx_attr.g0.Color0Comp = FORMAT_16B_4444;
+			m_vtx_attr.g0.Tex0CoordElements = 1;
+			m_vtx_attr.g0.Tex0CoordFormat = FORMAT_FLOAT;
+			break;
+		}
+	}
+};
+extern int gtest_TypicalLayoutsVertexLoaderLayoutTest_dummy_;
+INSTANTIATE_TEST_CASE_P(TypicalLayouts, VertexLoaderLayoutTest, ::testing::Range(0, (int)NUM_TYPICAL_LAYOUTS));
+
+TEST_P(VertexLoaderLayoutTest, PathsMatch)
+{
+	if (!cpu_info.bAVX2)
+		return;
+
+	SetLayout(GetParam());
+	FillInput(64);
+
+	// Skip a few vertices with a position index of 0xFFFF, including both
+	// vertices of a pair and an odd one at the end.
+	const int count = 1001;
+	int skipped = 0;
+	std::unique_ptr<VertexLoaderBase> loader(VertexLoaderBase::CreateVertexLoader(m_vtx_desc, m_vtx_attr));
+	if (m_vtx_desc.Position == INDEX16)
+	{
+		const int pos_ofs = m_vtx_desc.PosMatIdx + m_vtx_desc.Tex0MatIdx;
+		for (int i : { 3, 10, 11, 500, 1000 })
+		{
+			input_memory[i * loader->m_VertexSize + pos_ofs] = 0xFF;
+			input_memory[i * loader->m_VertexSize + pos_ofs + 1] = 0xFF;
+			skipped++;
+		}
+	}
+
+	const bool has_avx2 = cpu_info.bAVX2;
+	cpu_info.bAVX2 = false;
+	m_loader.reset(VertexLoaderBase::CreateVertexLoader(m_vtx_desc, m_vtx_attr));
+	cpu_info.bAVX2 = has_avx2;
+	RunVertices(count, count - skipped);
+	const size_t size = (count - skipped) * m_loader->m_native_vtx_decl.stride;
+	std::vector<u8> expected(output_memory, output_memory + size);
+
+	memset(output_memory, 0xFF, size);
+	m_loader.reset(VertexLoaderBase::CreateVertexLoader(m_vtx_desc, m_vtx_attr));
+	RunVertices(count, count - skipped);
+	EXPECT_EQ(0, memcmp(expected.data(), output_memory, size));
+}
+
+TEST_P(VertexLoaderLayoutTest, Speed)
+{
+	const char* names[] = { "direct s16 position", "direct float", "indexed float", "indexed s16", "indexed skinned" };
+	printf("layout: %s\n", names[GetParam()]);
+	SetLayout(GetParam());
+	FillInput(64);
+	Benchmark(100000, 1000);
 }